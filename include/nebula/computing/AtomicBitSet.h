@@ -0,0 +1,55 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace nebula::computing {
+
+/**
+ * @brief AtomicBitSet is a fixed size bit set whose bits can be set/reset concurrently, e.g.
+ *  to deduplicate the vertices added to a frontier from the parallel tasks. It's indexed by
+ *  the dense indices of `VertexIndex`.
+ */
+class AtomicBitSet final {
+public:
+    explicit AtomicBitSet(size_t size)
+            : size_(size), words_(std::make_unique<std::atomic<uint64_t>[]>(numWords())) {}
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool get(size_t idx) const {
+        return (words_[idx >> 6].load(std::memory_order_relaxed) & mask(idx)) != 0;
+    }
+
+    /**
+     * @brief Set the bit.
+     * @return true if the bit was unset, i.e. only one of the concurrent callers gets true.
+     */
+    bool testAndSet(size_t idx) {
+        auto bit = mask(idx);
+        return (words_[idx >> 6].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+    }
+
+    void reset(size_t idx) {
+        words_[idx >> 6].fetch_and(~mask(idx), std::memory_order_relaxed);
+    }
+
+private:
+    static uint64_t mask(size_t idx) {
+        return uint64_t{1} << (idx & 63);
+    }
+
+    size_t numWords() const {
+        return (size_ + 63) / 64;
+    }
+
+    size_t size_{0};
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+};
+
+}  // namespace nebula::computing
@@ -0,0 +1,218 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <folly/Range.h>
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "nebula/common/datatype/EdgeID.h"
+#include "nebula/common/graph/MemGraph.h"
+#include "nebula/common/utils/EdgeUtils.h"
+#include "nebula/common/utils/Types.h"
+#include "nebula/computing/ComputingEngine.h"
+#include "nebula/computing/VertexIndex.h"
+
+namespace nebula::computing {
+
+/**
+ * @brief CSRGraph is an immutable compressed sparse row snapshot of a MemGraph over the dense
+ *  vertex indices. The out and in edges of each vertex are stored contiguously and ordered by
+ *  edge type, so scanning the neighbors is sequential and lock free, unlike walking the
+ *  adjacency lists of MemGraph under its read lock. The edges inserted into MemGraph after the
+ *  snapshot is taken are not in it.
+ */
+class CSRGraph final {
+public:
+    enum class Direction : uint8_t {
+        kOut = 0,
+        kIn,
+    };
+
+    /**
+     * @brief Take the snapshot of the graph in parallel.
+     * @param index The dense index of the vertices, a new one is built if it's null.
+     */
+    static std::unique_ptr<CSRGraph> build(const MemGraph* graph,
+                                           ComputingEngine* engine,
+                                           std::shared_ptr<const VertexIndex> index = nullptr) {
+        if (!index) {
+            index = std::make_shared<VertexIndex>(graph->nodeIDs());
+        }
+        auto csr = std::make_unique<CSRGraph>();
+        csr->index_ = std::move(index);
+        csr->out_ = buildAdjacency(graph, engine, *csr->index_, Direction::kOut);
+        csr->in_ = buildAdjacency(graph, engine, *csr->index_, Direction::kIn);
+        return csr;
+    }
+
+    size_t numNodes() const {
+        return index_->size();
+    }
+
+    size_t numEdges(Direction dir = Direction::kOut) const {
+        return adjacency(dir).nbrs.size();
+    }
+
+    const VertexIndex& vertexIndex() const {
+        return *index_;
+    }
+
+    std::shared_ptr<const VertexIndex> sharedVertexIndex() const {
+        return index_;
+    }
+
+    size_t degree(uint32_t v, Direction dir) const {
+        const auto& adj = adjacency(dir);
+        return adj.offsets[v + 1] - adj.offsets[v];
+    }
+
+    /**
+     * @brief The dense indices of the neighbors of the given vertex.
+     */
+    folly::Range<const uint32_t*> neighbors(uint32_t v, Direction dir) const {
+        const auto& adj = adjacency(dir);
+        return {adj.nbrs.data() + adj.offsets[v], adj.nbrs.data() + adj.offsets[v + 1]};
+    }
+
+    /**
+     * @brief The dense indices of the neighbors through the edges of the given type (without
+     *  direction). The edges of a vertex are ordered by type, so it's the slice found by a
+     *  binary search rather than a scan of all the adjacent edges.
+     */
+    folly::Range<const uint32_t*> neighbors(uint32_t v, Direction dir, EdgeTypeID type) const {
+        const auto& adj = adjacency(dir);
+        auto first = adj.types.begin() + adj.offsets[v];
+        auto last = adj.types.begin() + adj.offsets[v + 1];
+        auto [lo, hi] = std::equal_range(first, last, type);
+        const auto* begin = adj.nbrs.data() + (lo - adj.types.begin());
+        return {begin, begin + (hi - lo)};
+    }
+
+    /**
+     * @brief The types (without direction) of the adjacent edges, in the same order as
+     *  `neighbors`.
+     */
+    folly::Range<const EdgeTypeID*> edgeTypes(uint32_t v, Direction dir) const {
+        const auto& adj = adjacency(dir);
+        return {adj.types.data() + adj.offsets[v], adj.types.data() + adj.offsets[v + 1]};
+    }
+
+    /**
+     * @brief The IDs of the adjacent edges, which are the handles to their properties in
+     *  MemGraph, in the same order as `neighbors`.
+     */
+    folly::Range<const EdgeID*> edgeIDs(uint32_t v, Direction dir) const {
+        const auto& adj = adjacency(dir);
+        return {adj.eids.data() + adj.offsets[v], adj.eids.data() + adj.offsets[v + 1]};
+    }
+
+    /**
+     * @brief Call `f(const EdgeID& sample, folly::Range<const uint32_t*> nbrs)` once for each
+     *  run of the adjacent edges of the same type, `sample` is the first edge of the run.
+     */
+    template <typename F>
+    void forEachTypeRun(uint32_t v, Direction dir, F&& f) const {
+        const auto& adj = adjacency(dir);
+        auto begin = adj.offsets[v], end = adj.offsets[v + 1];
+        while (begin < end) {
+            auto runEnd = begin + 1;
+            while (runEnd < end && adj.types[runEnd] == adj.types[begin]) {
+                ++runEnd;
+            }
+            f(adj.eids[begin],
+              folly::Range<const uint32_t*>(adj.nbrs.data() + begin, adj.nbrs.data() + runEnd));
+            begin = runEnd;
+        }
+    }
+
+private:
+    struct Adjacency {
+        std::vector<size_t> offsets;
+        std::vector<uint32_t> nbrs;
+        std::vector<EdgeTypeID> types;
+        std::vector<EdgeID> eids;
+    };
+
+    struct Entry {
+        EdgeTypeID type;
+        uint32_t nbr;
+        EdgeID eid;
+    };
+
+    const Adjacency& adjacency(Direction dir) const {
+        return dir == Direction::kOut ? out_ : in_;
+    }
+
+    template <typename Iterator>
+    static void collect(Iterator b,
+                        Iterator e,
+                        const VertexIndex& index,
+                        Direction dir,
+                        std::vector<Entry>* entries) {
+        for (; b != e; ++b) {
+            auto nbr = index.indexOf(dir == Direction::kOut ? b.getDstID() : b.getSrcID());
+            if (nbr == VertexIndex::kInvalidIndex) continue;
+            EdgeID eid = *b;
+            auto type = EdgeUtils::removeDirection(eid.edgeTypeID);
+            entries->push_back(Entry{type, nbr, std::move(eid)});
+        }
+    }
+
+    static Adjacency buildAdjacency(const MemGraph* graph,
+                                    ComputingEngine* engine,
+                                    const VertexIndex& index,
+                                    Direction dir) {
+        std::vector<uint32_t> vs(index.size());
+        std::iota(vs.begin(), vs.end(), 0u);
+
+        // Collect the sorted adjacent edges of each vertex in parallel
+        auto collectOne = [graph, &index, dir](uint32_t v) {
+            std::vector<Entry> entries;
+            auto vid = index.vid(v);
+            if (dir == Direction::kOut) {
+                auto [b, e] = graph->outEdges(vid);
+                collect(b, e, index, dir, &entries);
+            } else {
+                auto [b, e] = graph->inEdges(vid);
+                collect(b, e, index, dir, &entries);
+            }
+            std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+                return a.type < b.type;
+            });
+            return entries;
+        };
+        auto adjs = engine->runOnCurrentThread(engine->parallelFor(vs, collectOne));
+
+        Adjacency adj;
+        adj.offsets.resize(index.size() + 1, 0u);
+        for (size_t v = 0; v < adjs.size(); ++v) {
+            adj.offsets[v + 1] = adj.offsets[v] + adjs[v].size();
+        }
+        adj.nbrs.resize(adj.offsets.back());
+        adj.types.resize(adj.offsets.back());
+        adj.eids.resize(adj.offsets.back());
+
+        // Scatter them into the flat arrays in parallel, each vertex owns its range
+        auto fill = [&adj, &adjs](uint32_t v) {
+            auto pos = adj.offsets[v];
+            for (auto& entry : adjs[v]) {
+                adj.nbrs[pos] = entry.nbr;
+                adj.types[pos] = entry.type;
+                adj.eids[pos] = std::move(entry.eid);
+                ++pos;
+            }
+        };
+        engine->runOnCurrentThread(engine->parallelFor(vs, fill));
+        return adj;
+    }
+
+    std::shared_ptr<const VertexIndex> index_;
+    Adjacency out_;
+    Adjacency in_;
+};
+
+}  // namespace nebula::computing
@@ -0,0 +1,52 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+
+namespace nebula::computing {
+
+/**
+ * @brief The combiners of the values reduced per destination by `edgeMap`. A combiner declares
+ *  the `value_type` it reduces and `combine(acc, value)` which folds a value into the
+ *  accumulator. The accumulator starts from the first value, so a combiner needs no identity.
+ *  Any type of the same shape can be used as a custom combiner.
+ */
+template <typename T>
+struct SumCombiner {
+    using value_type = T;
+
+    static void combine(T& acc, const T& value) {
+        acc += value;
+    }
+};
+
+template <typename T>
+struct MinCombiner {
+    using value_type = T;
+
+    static void combine(T& acc, const T& value) {
+        acc = std::min(acc, value);
+    }
+};
+
+template <typename T>
+struct MaxCombiner {
+    using value_type = T;
+
+    static void combine(T& acc, const T& value) {
+        acc = std::max(acc, value);
+    }
+};
+
+/**
+ * @brief Keep the value from the first source in the order of the frontier.
+ */
+template <typename T>
+struct FirstCombiner {
+    using value_type = T;
+
+    static void combine(T&, const T&) {}
+};
+
+}  // namespace nebula::computing
@@ -2,14 +2,34 @@
 
 #pragma once
 
+#include <folly/Likely.h>
+#include <folly/hash/Hash.h>
+#include <folly/concurrency/ConcurrentHashMap.h>
+
+#include <algorithm>
+#include <initializer_list>
+#include <mutex>
+#include <numeric>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "nebula/common/datatype/EdgeID.h"
 #include "nebula/common/datatype/ResultTable.h"
 #include "nebula/common/graph/MemGraph.h"
+#include "nebula/common/utils/EdgeUtils.h"
 #include "nebula/common/utils/Types.h"
+#include "nebula/common/utils/Utils.h"
+#include "nebula/computing/AtomicBitSet.h"
+#include "nebula/computing/CSRGraph.h"
+#include "nebula/computing/Combiner.h"
 #include "nebula/computing/ComputingContext.h"
 #include "nebula/computing/ComputingEngine.h"
+#include "nebula/computing/LabelMask.h"
+#include "nebula/computing/LabelPath.h"
+#include "nebula/computing/MutationLog.h"
+#include "nebula/computing/MutationSink.h"
+#include "nebula/computing/StageProfiler.h"
+#include "nebula/computing/VertexIndex.h"
 #include "nebula/computing/VertexSubset.h"
 
 namespace nebula::computing {
@@ -19,8 +39,6 @@ public:
     template <typename T>
     using EdgeMapFn = std::function<T(NodeID, NodeID)>;
     using EdgeFilterFn = std::function<bool(NodeID, NodeID)>;
-    template <typename T>
-    using ReduceFn = std::function<T(const T&, NodeID)>;
 
     /**
      * @brief The direction of the edge to be traversed
@@ -116,12 +134,24 @@ class ComputingAlgorithm : public ComputingAlgorithmBase {
 public:
     using BaseType = ComputingAlgorithm<StateType>;
 
-    explicit ComputingAlgorithm(ComputingContext* ctx) : ComputingAlgorithmBase(ctx) {
-        states_.reserve(graph()->numNodes());
-        for (auto [begin, end] = graph()->nodes(); begin != end; ++begin) {
-            states_.emplace(*begin, StateType());
-        }
-    }
+    explicit ComputingAlgorithm(ComputingContext* ctx)
+            : ComputingAlgorithmBase(ctx),
+              vertexIndex_(std::make_shared<VertexIndex>(graph()->nodeIDs())),
+              states_(vertexIndex_->size()),
+              mutations_(
+                      ctx->engine(),
+                      [this](const auto& type, const auto& rows) {
+                          writeRows(rows.size(), [&](size_t i) { insertNode(type, rows[i]); });
+                          insertedNodes_ += rows.size();
+                      },
+                      [this](const auto& type, const auto& rows) {
+                          writeRows(rows.size(), [&](size_t i) {
+                              insertEdge(type, rows.srcPKs[i], rows.dstPKs[i], rows.props[i]);
+                          });
+                      },
+                      [this](const auto& edges) {
+                          writeRows(edges.size(), [&](size_t i) { updateEdge(edges[i]); });
+                      }) {}
 
     ~ComputingAlgorithm() override = default;
 
@@ -136,9 +166,9 @@ public:
      * @brief edgeMap is the basic operation of all algorithms.
      * @param u The vertex subset to be operated on.
      * @param f The filter function of edge.
-     * @param m The function to be applied to each edge.
+     * @param m The function to be applied to each edge, its results are not reduced, see
+     *  the overload with a combiner to reduce them.
      * @param c The filter function to each target vertex of adjacent edges of vertex in u.
-     * @param r The reduce function to merge the results of each target vertex.
      * @param dir The direction of the edge.
      * @return The vertex subset after the operation.
      */
@@ -147,9 +177,44 @@ public:
                          EdgeFilterFn f,
                          EdgeMapFn<T> m,
                          VertexFilterFn c,
-                         ReduceFn<T> r,
                          EdgeDirection dir = EdgeDirection::kOutEdge) const;
 
+    /**
+     * @brief edgeMap taking any callables `f(s, d) -> bool`, `m(s, d)` and `c(d) -> bool`
+     *  instead of `std::function`, so that they are inlined into the scan of the edges.
+     */
+    template <typename F,
+              typename M,
+              typename C,
+              typename = std::enable_if_t<std::is_invocable_r_v<bool, F, NodeID, NodeID>>>
+    VertexSubset edgeMap(VertexSubset& u,
+                         F&& f,
+                         M&& m,
+                         C&& c,
+                         EdgeDirection dir = EdgeDirection::kOutEdge) const {
+        if (u.size() > graph()->numNodes() / kThresholdParam) {
+            return edgeMapDense(u, f, m, c, dir);
+        }
+        return edgeMapSparse(u, f, m, c, dir);
+    }
+
+    /**
+     * @brief edgeMap which reduces the values of `m` per target vertex by `Combiner`, e.g.
+     *  `SumCombiner<double>`, and writes the result into the field of its state. The values
+     *  are reduced into a partial result per task without atomics, then the partials are
+     *  merged in the order of the tasks, see `ComputingEngine::parallelReduce`.
+     * @param field The member of the state to write the reduced value into, e.g.
+     *  `&PageRankState::rank`. The targets that receive no value are left untouched.
+     * @return The targets that receive any value.
+     */
+    template <typename Combiner, typename F, typename M, typename C>
+    VertexSubset edgeMap(const VertexSubset& u,
+                         F&& f,
+                         M&& m,
+                         C&& c,
+                         typename Combiner::value_type StateType::*field,
+                         EdgeDirection dir = EdgeDirection::kOutEdge);
+
     /**
      * @brief vertexMap is used to perform the vertex action when the vertex in u meets the
      * filter f
@@ -159,6 +224,25 @@ public:
      */
     VertexSubset vertexMap(VertexSubset& u, VertexFilterFn f, VertexActionFn m);
 
+    /**
+     * @brief vertexMap taking any callables instead of `std::function`.
+     */
+    template <typename F,
+              typename M,
+              typename = std::enable_if_t<std::is_invocable_r_v<bool, F, NodeID>>>
+    VertexSubset vertexMap(const VertexSubset& u, F&& f, M&& m) {
+        auto engine = ctx_->engine();
+        auto future =
+                engine->parallelFilter(u.vids(), [&f, &m](NodeID id, std::vector<NodeID>& res) {
+                    if (f(id)) {
+                        m(id);
+                        res.push_back(id);
+                    }
+                });
+        auto vids = engine->runOnCurrentThread(std::move(future));
+        return VertexSubset(ctx_, std::move(vids));
+    }
+
     /**
      * @brief vSize return the number of vertices in VertexSubset
      */
@@ -167,14 +251,44 @@ public:
     }
 
     /**
-     * @brief this functions are used to get the state of the given vertex.
+     * @brief this functions are used to get the state of the given vertex. The vertices
+     *  inserted by the algorithm, e.g. the flushed nodes, aren't indexed and have their states
+     *  kept aside, any other vid is a bug. The const overload doesn't create the state of an
+     *  inserted vertex, it returns the default state if it hasn't been written yet.
      */
     StateType& state(NodeID vid) {
-        DCHECK(states_.find(vid) != states_.end()) << "Invalid vid: " << vid;
-        return states_[vid];
+        auto idx = vertexIndex_->indexOf(vid);
+        if (LIKELY(idx != VertexIndex::kInvalidIndex)) {
+            return states_[idx];
+        }
+        DCHECK(insertedVertex(vid)) << "Invalid vid: " << vid;
+        return extraState(vid);
     }
     const StateType& state(NodeID vid) const {
-        return const_cast<ComputingAlgorithm*>(this)->state(vid);
+        auto idx = vertexIndex_->indexOf(vid);
+        if (LIKELY(idx != VertexIndex::kInvalidIndex)) {
+            return states_[idx];
+        }
+        DCHECK(insertedVertex(vid)) << "Invalid vid: " << vid;
+        return extraState(vid);
+    }
+
+    /**
+     * @brief Get the state by the dense index of the vertex, see `vertexIndex()`.
+     */
+    StateType& stateAt(uint32_t idx) {
+        return states_[idx];
+    }
+    const StateType& stateAt(uint32_t idx) const {
+        return states_[idx];
+    }
+
+    /**
+     * @brief The dense index of the vertices of the graph when the algorithm is created, the
+     *  states are stored in this order.
+     */
+    const VertexIndex& vertexIndex() const {
+        return *vertexIndex_;
     }
 
     /**
@@ -183,20 +297,96 @@ public:
      */
     void getResult(ResultTable* result) const;
 
+    /**
+     * @brief Get the result of only the vertices whose state passes `pred`, e.g. the touched
+     *  ones, see `streamResult`.
+     */
+    template <typename Pred>
+    void getResult(ResultTable* result, Pred pred) const {
+        streamResult(pred, kResultBatchSize, [result](ResultTable&& batch) {
+            result->merge(std::move(batch));
+        });
+    }
+
+    /**
+     * @brief Stream the result of the vertices whose state passes `pred` to `sink` in batches
+     *  of at most `batchSize` rows, in the order of the vertex index. The rows are built in
+     *  parallel per chunk of vertices, and only a window of chunks is materialized at a time.
+     * @param sink Called with each `ResultTable&&` batch on the current thread.
+     */
+    template <typename Pred, typename Sink>
+    void streamResult(Pred pred, size_t batchSize, Sink sink) const;
+
+    static constexpr size_t kResultBatchSize = 65536;
+
+    /**
+     * @brief The profiler of the stages of the algorithm, disabled unless enabled before
+     *  `run`.
+     */
+    StageProfiler& profiler() {
+        return profiler_;
+    }
+    const StageProfiler& profiler() const {
+        return profiler_;
+    }
+
+    /**
+     * @brief Add the writes flushed from now on to `log` instead of applying them to the
+     *  graph, e.g. for a dry run. The algorithm must not read back what it has written then.
+     */
+    void captureMutations(MutationLog* log) {
+        mutationLog_ = log;
+        mutations_.redirect(
+                [log](const auto& type, const auto& rows) {
+                    for (const auto& props : rows) {
+                        log->addNode(type, props);
+                    }
+                },
+                [log](const auto& type, const auto& rows) {
+                    for (size_t i = 0; i < rows.size(); ++i) {
+                        log->addEdge(type, rows.srcPKs[i], rows.dstPKs[i], rows.props[i]);
+                    }
+                },
+                [log](const auto& edges) {
+                    for (const auto& edge : edges) {
+                        log->addUpdate(edge);
+                    }
+                });
+    }
+
+    bool capturingMutations() const {
+        return mutationLog_ != nullptr;
+    }
+
+    /**
+     * @brief Get one row per stage recorded by the profiler, with the columns of
+     *  `kProfileColumnNames`. The times are in microseconds.
+     */
+    void getProfileResult(ResultTable* result) const;
+
+    static constexpr const char* kProfileColumnNames[] = {
+            "stage",
+            "wallUs",
+            "cpuUs",
+            "inputSize",
+            "outputSize",
+            "edgesScanned",
+            "propertyReads",
+            "mutations",
+    };
+
 protected:
-    template <typename T>
+    template <typename F, typename M, typename C>
     VertexSubset edgeMapSparse(VertexSubset& u,
-                               EdgeFilterFn f,
-                               EdgeMapFn<T> m,
-                               VertexFilterFn c,
-                               ReduceFn<T> r,
+                               const F& f,
+                               const M& m,
+                               const C& c,
                                EdgeDirection dir = EdgeDirection::kOutEdge) const;
-    template <typename T>
+    template <typename F, typename M, typename C>
     VertexSubset edgeMapDense(VertexSubset& u,
-                              EdgeFilterFn f,
-                              EdgeMapFn<T> m,
-                              VertexFilterFn c,
-                              ReduceFn<T> r,
+                              const F& f,
+                              const M& m,
+                              const C& c,
                               EdgeDirection dir = EdgeDirection::kOutEdge) const;
 
     template <typename T>
@@ -221,21 +411,296 @@ protected:
         } while (!casOp(ptr, oldV, newV));
     }
 
+    /**
+     * @return true if `val` is greater than the old value, i.e. the value is changed.
+     */
     template <typename T>
-    static void writeMax(T* ptr, T val) {
+    static bool writeMax(T* ptr, T val) {
         volatile T newV, oldV;
         do {
             oldV = *ptr;
             newV = oldV > val ? oldV : val;
         } while (!casOp(ptr, oldV, newV));
+        return newV != oldV;
+    }
+
+    /**
+     * @brief Resolve the labels to match into a mask. Resolve it once before the traversal
+     *  rather than per edge, then match it with `hasNodeLabel`/`hasEdgeLabel`.
+     */
+    LabelMask labelMask(std::initializer_list<Label> labels) const {
+        return labelInterner_.mask(labels);
+    }
+    LabelMask labelMask(const std::set<Label>& labels) const {
+        return labelInterner_.mask(labels);
     }
 
+    /**
+     * @brief The label mask of the given node/edge, which is cached by the node/edge type. It
+     *  only has the labels resolved by `labelMask` so far.
+     */
+    LabelMask nodeLabelMask(NodeID vid) const;
+    LabelMask edgeLabelMask(const EdgeID& eid) const;
+
+    /**
+     * @brief Whether the given node/edge has any label in the mask.
+     */
+    bool hasNodeLabel(NodeID vid, const LabelMask& mask) const {
+        return nodeLabelMask(vid).intersects(mask) ||
+               (mask.hasOverflow() && mask.overflowMatches(getNodeLabelSet(vid)));
+    }
+    bool hasEdgeLabel(const EdgeID& eid, const LabelMask& mask) const {
+        return edgeLabelMask(eid).intersects(mask) ||
+               (mask.hasOverflow() && mask.overflowMatches(getEdgeLabelSet(eid)));
+    }
+
+    /**
+     * @brief The counterparts of `MemGraph::getProperty`/`hasProperty` which are counted by
+     *  the stage profiler.
+     */
+    Value getProperty(NodeID vid, const std::string& propName) const {
+        profiler_.count(StageProfiler::kPropertyReads);
+        return graph()->getProperty(vid, propName);
+    }
+    Value getProperty(const EdgeID& eid, const std::string& propName) const {
+        profiler_.count(StageProfiler::kPropertyReads);
+        return graph()->getProperty(eid, propName);
+    }
+    bool hasProperty(NodeID vid,
+                     const std::string& propName,
+                     MemGraph::PropFilterFn cond) const {
+        profiler_.count(StageProfiler::kPropertyReads);
+        return graph()->hasProperty(vid, propName, std::move(cond));
+    }
+
+    /**
+     * @brief The edge filter of MemGraph to select the edges with any label in the mask. The
+     *  mask is captured by reference to keep the filter small, so it must outlive the filter.
+     */
+    MemGraph::EdgeFilterFn edgeLabelFilter(const LabelMask& mask) const {
+        return [this, &mask](const Edge& e) -> bool {
+            return hasEdgeLabel(e.getEdgeID(), mask);
+        };
+    }
+
+    /**
+     * @brief The buffered counterparts of `insertNode`/`insertEdge`/`updateEdge`, which are
+     *  safe to call from parallel stages and applied in bulk by `flushMutations`. Flush before
+     *  reading back the written nodes/edges from the graph.
+     */
+    void emitNode(const std::string& nodeTypeName, properties_type props) {
+        profiler_.count(StageProfiler::kMutations);
+        mutations_.insertNode(nodeTypeName, std::move(props));
+    }
+    void emitEdge(const std::string& edgeTypeName,
+                  std::vector<Value> srcPK,
+                  std::vector<Value> dstPK,
+                  properties_type props = {}) {
+        profiler_.count(StageProfiler::kMutations);
+        mutations_.insertEdge(
+                edgeTypeName, std::move(srcPK), std::move(dstPK), std::move(props));
+    }
+    template <typename Record>
+    void emitEdgeRecord(const std::string& edgeTypeName, Record record) {
+        profiler_.count(StageProfiler::kMutations);
+        mutations_.insertEdgeRecord(edgeTypeName, std::move(record));
+    }
+    template <typename Record, typename Overlay>
+    void emitEdgePair(const std::string& edgeTypeName, Record forward, Overlay backward) {
+        profiler_.count(StageProfiler::kMutations, 2u);
+        mutations_.insertEdgePair(edgeTypeName, std::move(forward), std::move(backward));
+    }
+    void emitEdgeUpdate(Edge edge) {
+        profiler_.count(StageProfiler::kMutations);
+        mutations_.updateEdge(std::move(edge));
+    }
+
+    size_t flushMutations() {
+        return mutations_.flush();
+    }
+
+    /**
+     * @brief Take the CSR snapshot of the graph, then `edgeMap` and `neighborIDs` scan it
+     *  instead of MemGraph. It doesn't see the edges inserted by the algorithm later.
+     */
+    void buildCSR() {
+        csr_ = CSRGraph::build(graph(), ctx_->engine(), vertexIndex_);
+    }
+
+    const CSRGraph* csr() const {
+        return csr_.get();
+    }
+
+    /**
+     * @brief Match the label path from each source by a DFS per source in parallel, without
+     *  materializing the vertices of the intermediate hops. A value is carried along each
+     *  path, `init(s)` gives it at the source, and `visit(u, v, value)` is called on each hop
+     *  and returns the value carried on to `v`. A vertex is expanded once per source at each
+     *  (step, count) of the path, like a chain of `map` calls dedups each hop, so the paths
+     *  which revisit it, e.g. going back through the same switch, don't multiply the work.
+     *  The value carried is the one of the first path reaching it.
+     * @return The vertices at the end of the matched paths.
+     */
+    template <typename T, typename Init, typename Visit>
+    VertexSubset pathMap(const VertexSubset& sources,
+                         const LabelPath& path,
+                         Init init,
+                         Visit visit) const;
+
+    /**
+     * @brief Propagate the values of the vertices through the edges with any label in the mask
+     *  until none changes. `relax(u, v)` updates the value of `v` from `u` and returns whether
+     *  it changed. Only the vertices changed in the previous round are expanded, pushed to
+     *  their neighbors when the frontier is sparse and pulled by all vertices when it's
+     *  dense. `relax` must be thread-safe and monotone, e.g. by `writeMax`.
+     * @return The number of rounds.
+     */
+    template <typename Relax>
+    size_t fixpoint(const VertexSubset& initial,
+                    const LabelMask& edges,
+                    Relax relax,
+                    EdgeDirection dir = EdgeDirection::kBothEdge) const;
+
+    /**
+     * @brief Get the neighbors through the edges with any label in the mask. Only the runs
+     *  of the matched edge types are visited when the CSR snapshot is built, otherwise all
+     *  adjacent edges in MemGraph are filtered.
+     */
+    std::vector<NodeID> neighborIDs(NodeID vid,
+                                    const LabelMask& mask,
+                                    EdgeDirection dir = EdgeDirection::kBothEdge) const;
+
+    /**
+     * @brief Get the neighbors through the edges of the given types, which are without
+     *  direction. When the CSR snapshot is built only the slice of each type is read,
+     *  otherwise the adjacent edges in MemGraph are filtered by type.
+     */
+    std::vector<NodeID> neighborIDs(NodeID vid,
+                                    folly::Range<const EdgeTypeID*> types,
+                                    EdgeDirection dir = EdgeDirection::kBothEdge) const;
+    std::vector<NodeID> outNeighborIDs(NodeID vid, EdgeTypeID type) const {
+        return neighborIDs(
+                vid, folly::Range<const EdgeTypeID*>(&type, 1), EdgeDirection::kOutEdge);
+    }
+    std::vector<NodeID> inNeighborIDs(NodeID vid, EdgeTypeID type) const {
+        return neighborIDs(
+                vid, folly::Range<const EdgeTypeID*>(&type, 1), EdgeDirection::kInEdge);
+    }
+
+    /**
+     * @brief Get the neighbors through the edges passing `filter(const EdgeID&) -> bool`,
+     *  which is inlined into the scan of the adjacent edges in MemGraph instead of called
+     *  through `MemGraph::EdgeFilterFn` with the `Edge` built for each edge. Unlike the
+     *  label mask overload, it always scans MemGraph, so it sees the edges written by the
+     *  algorithm after the CSR snapshot was taken.
+     */
+    template <typename F,
+              typename = std::enable_if_t<std::is_invocable_r_v<bool, F, const EdgeID&>>>
+    std::vector<NodeID> neighborIDs(NodeID vid,
+                                    F&& filter,
+                                    EdgeDirection dir = EdgeDirection::kBothEdge) const {
+        std::vector<NodeID> res;
+        auto collect = [vid, &filter, &res](const EdgeID& eid) {
+            if (filter(eid)) {
+                res.push_back(eid.srcID == vid ? eid.dstID : eid.srcID);
+            }
+        };
+        if (dir != EdgeDirection::kInEdge) {
+            for (auto [b, e] = graph()->outEdges(vid); b != e; ++b) {
+                collect(*b);
+            }
+        }
+        if (dir != EdgeDirection::kOutEdge) {
+            for (auto [b, e] = graph()->inEdges(vid); b != e; ++b) {
+                collect(*b);
+            }
+        }
+        profiler_.count(StageProfiler::kEdgesScanned, res.size());
+        return res;
+    }
+
+    /**
+     * @brief The filter of the edges with any label in the mask for the template
+     *  `neighborIDs`. Like `edgeLabelFilter`, the mask must outlive the filter.
+     */
+    auto edgeLabelMatcher(const LabelMask& mask) const {
+        return [this, &mask](const EdgeID& eid) { return hasEdgeLabel(eid, mask); };
+    }
 
 private:
     /**
-     * @brief The state of each vertex.
+     * @brief The state of the vertex which is not in the vertex index, e.g. inserted after the
+     *  algorithm was created.
      */
-    std::unordered_map<NodeID, StateType> states_;
+    StateType& extraState(NodeID vid) {
+        std::lock_guard<std::mutex> guard(extraStatesLock_);
+        return extraStates_[vid];
+    }
+    const StateType& extraState(NodeID vid) const {
+        static const StateType kDefaultState{};
+        std::lock_guard<std::mutex> guard(extraStatesLock_);
+        auto iter = extraStates_.find(vid);
+        // The elements of unordered_map aren't moved by the later inserts
+        return iter == extraStates_.end() ? kDefaultState : iter->second;
+    }
+
+    /**
+     * @brief Whether the vertex could have been inserted by the algorithm: the algorithm has
+     *  written nodes to the graph since the index was built and the vertex is in the graph.
+     */
+    bool insertedVertex(NodeID vid) const {
+        return insertedNodes_ > 0 && graph()->getNode(vid).has_value();
+    }
+
+    std::shared_ptr<const VertexIndex> vertexIndex_;
+    /**
+     * @brief The state of each vertex, indexed by `vertexIndex_`.
+     */
+    std::vector<StateType> states_;
+    mutable std::mutex extraStatesLock_;
+    std::unordered_map<NodeID, StateType> extraStates_;
+
+    MutationSink mutations_;
+    MutationLog* mutationLog_{nullptr};
+    // The number of nodes written to the graph by `mutations_`
+    size_t insertedNodes_{0};
+
+    /**
+     * @brief Write a batch flushed by `mutations_` to the graph. ComputingAlgorithmBase only
+     *  writes one node/edge at a time, so the rows of the batch are written in parallel.
+     */
+    template <typename Write>
+    void writeRows(size_t n, Write&& write) {
+        std::vector<size_t> rows(n);
+        std::iota(rows.begin(), rows.end(), size_t{0});
+        auto* engine = ctx_->engine();
+        engine->runOnCurrentThread(engine->parallelFor(rows, write));
+    }
+
+    /**
+     * @brief Get all neighbors of the given vertex from the CSR snapshot if it's built.
+     */
+    std::vector<NodeID> adjacentIDs(NodeID vid, EdgeDirection dir) const;
+
+    std::vector<NodeID> matchedNeighborIDs(NodeID vid,
+                                           const LabelMask& mask,
+                                           EdgeDirection dir) const;
+
+    std::unique_ptr<CSRGraph> csr_;
+    StageProfiler profiler_;
+
+    /**
+     * @brief The label mask of a node/edge type, built when `labelInterner_` had `numLabels`
+     *  labels. It's rebuilt once more labels are interned.
+     */
+    struct TypeLabelMask {
+        uint32_t numLabels;
+        LabelMask mask;
+    };
+
+    mutable LabelInterner labelInterner_;
+    mutable folly::ConcurrentHashMap<NodeTypeID, TypeLabelMask> nodeLabelMasks_;
+    mutable folly::ConcurrentHashMap<EdgeTypeID, TypeLabelMask> edgeLabelMasks_;
 };
 
 //---------- implementation --------------
@@ -246,55 +711,40 @@ VertexSubset ComputingAlgorithm<StateType>::edgeMap(VertexSubset& u,
                                                     EdgeFilterFn f,
                                                     EdgeMapFn<T> m,
                                                     VertexFilterFn c,
-                                                    ReduceFn<T> r,
                                                     EdgeDirection dir) const {
     if (u.size() > graph()->numNodes() / kThresholdParam) {
-        return edgeMapDense(u, f, m, c, r, dir);
+        return edgeMapDense(u, f, m, c, dir);
     }
-    return edgeMapSparse(u, f, m, c, r, dir);
+    return edgeMapSparse(u, f, m, c, dir);
 }
 
 template <typename StateType>
-template <typename T>
+template <typename F, typename M, typename C>
 VertexSubset ComputingAlgorithm<StateType>::edgeMapSparse(VertexSubset& u,
-                                                          EdgeFilterFn f,
-                                                          EdgeMapFn<T> m,
-                                                          VertexFilterFn c,
-                                                          ReduceFn<T> r,
+                                                          const F& f,
+                                                          const M& m,
+                                                          const C& c,
                                                           EdgeDirection dir) const {
     using NodeIDList = std::vector<NodeID>;
-    auto getTargets = [this, f, m, c, r, dir](NodeID srcId) -> folly::SemiFuture<NodeIDList> {
-        auto vFilter = [srcId, f, m, c](NodeID dstId,
-                                        std::unordered_map<NodeID, std::vector<T>>& tmp,
-                                        NodeIDList& res) {
+    auto getTargets = [this, &f, &m, &c, dir](NodeID srcId) -> folly::SemiFuture<NodeIDList> {
+        auto vFilter = [srcId, &f, &m, &c](NodeID dstId, NodeIDList& res) {
             if (f(srcId, dstId) && c(dstId)) {
-                tmp[dstId].emplace_back(m(srcId, dstId));
+                m(srcId, dstId);
                 res.push_back(dstId);
             }
         };
 
-        auto nbrs = neighbors(srcId, dir);
+        auto nbrs = adjacentIDs(srcId, dir);
+        profiler_.count(StageProfiler::kEdgesScanned, nbrs.size());
         if (nbrs.size() > ComputingEngine::kParallelThreshold) {
             // Use parallel filter if there are too many out edges
-            using UT = decltype(nbrs);
-            using FT = decltype(vFilter);
-            return ctx_->engine()->parallelReduce<UT, FT, T>(nbrs, vFilter, r);
+            return ctx_->engine()->parallelFilter(nbrs, vFilter);
         }
 
         std::vector<NodeID> res;
-        std::unordered_map<NodeID, std::vector<T>> tmp;
         for (auto tid : nbrs) {
-            vFilter(tid, tmp, res);
-        }
-        for (auto nbr : res) {
-            // FIXME(yee): init the value of T in reduce function?
-            T t;
-            DCHECK_GT(tmp.count(nbr), 0);
-            for (const auto& v : tmp[nbr]) {
-                t = r(t, v);
-            }
+            vFilter(tid, res);
         }
-
         return res;
     };
 
@@ -316,36 +766,62 @@ VertexSubset ComputingAlgorithm<StateType>::edgeMapSparse(VertexSubset& u,
 }
 
 template <typename StateType>
-template <typename T>
+template <typename F, typename M, typename C>
 VertexSubset ComputingAlgorithm<StateType>::edgeMapDense(VertexSubset& u,
-                                                         EdgeFilterFn f,
-                                                         EdgeMapFn<T> m,
-                                                         VertexFilterFn c,
-                                                         ReduceFn<T> r,
+                                                         const F& f,
+                                                         const M& m,
+                                                         const C& c,
                                                          EdgeDirection dir) const {
     // FIXME(yee): here get new all vertices each time
     auto allNodes = graph()->nodeIDs();
-    auto filter = [this, &u, f, m, c, dir](NodeID vid,
-                                           std::unordered_map<NodeID, std::vector<T>>& tmp,
-                                           std::vector<NodeID>& res) {
+    auto filter = [this, &u, &f, &m, &c, dir](NodeID vid, std::vector<NodeID>& res) {
         if (!c(vid)) return;
         // TODO(yee): handle in parallel when there are too many in edges
-        auto nbrs = neighbors(vid, reverse(dir));
+        auto nbrs = adjacentIDs(vid, reverse(dir));
+        profiler_.count(StageProfiler::kEdgesScanned, nbrs.size());
         for (auto tid : nbrs) {
             if (u.isIn(tid) && f(tid, vid)) {
-                tmp[vid].emplace_back(m(tid, vid));
+                m(tid, vid);
                 res.push_back(vid);
                 break;
             }
         }
     };
-    using UT = decltype(allNodes);
-    using FT = decltype(filter);
-    auto future = ctx_->engine()->parallelReduce<UT, FT, T>(allNodes, filter, r);
+    auto future = ctx_->engine()->parallelFilter(allNodes, filter);
     auto vids = ctx_->engine()->runOnCurrentThread(std::move(future));
     return VertexSubset(ctx_, std::move(vids));
 }
 
+template <typename StateType>
+template <typename Combiner, typename F, typename M, typename C>
+VertexSubset ComputingAlgorithm<StateType>::edgeMap(
+        const VertexSubset& u,
+        F&& f,
+        M&& m,
+        C&& c,
+        typename Combiner::value_type StateType::*field,
+        EdgeDirection dir) {
+    auto reduceSource = [this, &f, &m, &c, dir](NodeID src, auto& emit) {
+        auto nbrs = adjacentIDs(src, dir);
+        profiler_.count(StageProfiler::kEdgesScanned, nbrs.size());
+        for (auto dst : nbrs) {
+            if (f(src, dst) && c(dst)) {
+                emit(dst, m(src, dst));
+            }
+        }
+    };
+    auto* engine = ctx_->engine();
+    auto future = engine->parallelReduce<Combiner, NodeID>(u.vids(), reduceSource);
+    auto reduced = engine->runOnCurrentThread(std::move(future));
+
+    std::vector<NodeID> vids;
+    vids.reserve(reduced.size());
+    for (auto& [dst, value] : reduced) {
+        state(dst).*field = std::move(value);
+        vids.push_back(dst);
+    }
+    return VertexSubset(ctx_, std::move(vids));
+}
 
 template <typename StateType>
 VertexSubset ComputingAlgorithm<StateType>::vertexMap(VertexSubset& u,
@@ -362,15 +838,327 @@ VertexSubset ComputingAlgorithm<StateType>::vertexMap(VertexSubset& u,
     return VertexSubset(ctx_, std::move(vids));
 }
 
+template <typename StateType>
+LabelMask ComputingAlgorithm<StateType>::nodeLabelMask(NodeID vid) const {
+    auto type = NodeIDUtils::nodeType(vid);
+    auto numLabels = labelInterner_.size();
+    auto iter = nodeLabelMasks_.find(type);
+    if (iter != nodeLabelMasks_.cend() && iter->second.numLabels == numLabels) {
+        return iter->second.mask;
+    }
+    auto mask = labelInterner_.typeMask(getNodeLabelSet(vid));
+    nodeLabelMasks_.insert_or_assign(type, TypeLabelMask{numLabels, mask});
+    return mask;
+}
+
+template <typename StateType>
+LabelMask ComputingAlgorithm<StateType>::edgeLabelMask(const EdgeID& eid) const {
+    auto type = EdgeUtils::removeDirection(eid.edgeTypeID);
+    auto numLabels = labelInterner_.size();
+    auto iter = edgeLabelMasks_.find(type);
+    if (iter != edgeLabelMasks_.cend() && iter->second.numLabels == numLabels) {
+        return iter->second.mask;
+    }
+    auto mask = labelInterner_.typeMask(getEdgeLabelSet(eid));
+    edgeLabelMasks_.insert_or_assign(type, TypeLabelMask{numLabels, mask});
+    return mask;
+}
+
+template <typename StateType>
+std::vector<NodeID> ComputingAlgorithm<StateType>::neighborIDs(NodeID vid,
+                                                               const LabelMask& mask,
+                                                               EdgeDirection dir) const {
+    auto res = matchedNeighborIDs(vid, mask, dir);
+    profiler_.count(StageProfiler::kEdgesScanned, res.size());
+    return res;
+}
+
+template <typename StateType>
+std::vector<NodeID> ComputingAlgorithm<StateType>::neighborIDs(
+        NodeID vid, folly::Range<const EdgeTypeID*> types, EdgeDirection dir) const {
+    if (!csr_) {
+        return neighborIDs(
+                vid,
+                [types](const EdgeID& eid) {
+                    auto type = EdgeUtils::removeDirection(eid.edgeTypeID);
+                    return std::find(types.begin(), types.end(), type) != types.end();
+                },
+                dir);
+    }
+    std::vector<NodeID> res;
+    auto v = csr_->vertexIndex().indexOf(vid);
+    if (v == VertexIndex::kInvalidIndex) {
+        return res;
+    }
+    auto collect = [this, v, types, &res](CSRGraph::Direction d) {
+        for (auto type : types) {
+            for (auto nbr : csr_->neighbors(v, d, type)) {
+                res.push_back(csr_->vertexIndex().vid(nbr));
+            }
+        }
+    };
+    if (dir != EdgeDirection::kInEdge) {
+        collect(CSRGraph::Direction::kOut);
+    }
+    if (dir != EdgeDirection::kOutEdge) {
+        collect(CSRGraph::Direction::kIn);
+    }
+    profiler_.count(StageProfiler::kEdgesScanned, res.size());
+    return res;
+}
+
+template <typename StateType>
+std::vector<NodeID> ComputingAlgorithm<StateType>::matchedNeighborIDs(NodeID vid,
+                                                                      const LabelMask& mask,
+                                                                      EdgeDirection dir) const {
+    if (csr_) {
+        std::vector<NodeID> res;
+        auto v = csr_->vertexIndex().indexOf(vid);
+        if (v == VertexIndex::kInvalidIndex) {
+            return res;
+        }
+        auto collect = [this, &mask, &res](const EdgeID& sample, auto nbrs) {
+            if (hasEdgeLabel(sample, mask)) {
+                for (auto nbr : nbrs) {
+                    res.push_back(csr_->vertexIndex().vid(nbr));
+                }
+            }
+        };
+        if (dir != EdgeDirection::kInEdge) {
+            csr_->forEachTypeRun(v, CSRGraph::Direction::kOut, collect);
+        }
+        if (dir != EdgeDirection::kOutEdge) {
+            csr_->forEachTypeRun(v, CSRGraph::Direction::kIn, collect);
+        }
+        return res;
+    }
+
+    switch (dir) {
+        case EdgeDirection::kOutEdge:
+            return graph()->outNeighborIDs(vid, edgeLabelFilter(mask));
+        case EdgeDirection::kInEdge:
+            return graph()->inNeighborIDs(vid, edgeLabelFilter(mask));
+        default:
+            return graph()->neighborIDs(vid, edgeLabelFilter(mask));
+    }
+}
+
+template <typename StateType>
+std::vector<NodeID> ComputingAlgorithm<StateType>::adjacentIDs(NodeID vid,
+                                                               EdgeDirection dir) const {
+    if (!csr_) {
+        return neighbors(vid, dir);
+    }
+    std::vector<NodeID> res;
+    auto v = csr_->vertexIndex().indexOf(vid);
+    if (v == VertexIndex::kInvalidIndex) {
+        return res;
+    }
+    auto append = [this, &res, v](CSRGraph::Direction d) {
+        for (auto nbr : csr_->neighbors(v, d)) {
+            res.push_back(csr_->vertexIndex().vid(nbr));
+        }
+    };
+    if (dir != EdgeDirection::kInEdge) {
+        append(CSRGraph::Direction::kOut);
+    }
+    if (dir != EdgeDirection::kOutEdge) {
+        append(CSRGraph::Direction::kIn);
+    }
+    return res;
+}
+
 template <typename StateType>
 void ComputingAlgorithm<StateType>::getResult(ResultTable* result) const {
-    for (auto [begin, end] = graph()->nodes(); begin != end; ++begin) {
-        NodeID vid = *begin;
+    for (uint32_t idx = 0; idx < states_.size(); ++idx) {
+        Row row;
+        row.append(vertexIndex_->vid(idx));
+        states_[idx].getResult(row);
+        result->append(std::move(row));
+    }
+}
+
+template <typename StateType>
+void ComputingAlgorithm<StateType>::getProfileResult(ResultTable* result) const {
+    for (const auto& stage : profiler_.stages()) {
         Row row;
-        row.append(vid);
-        state(vid).getResult(row);
+        row.append(stage.name);
+        row.append(stage.wallUs);
+        row.append(stage.cpuUs);
+        row.append(stage.inputSize);
+        row.append(stage.outputSize);
+        for (auto counter : stage.counters) {
+            row.append(counter);
+        }
         result->append(std::move(row));
     }
 }
 
+template <typename StateType>
+template <typename T, typename Init, typename Visit>
+VertexSubset ComputingAlgorithm<StateType>::pathMap(const VertexSubset& sources,
+                                                    const LabelPath& path,
+                                                    Init init,
+                                                    Visit visit) const {
+    struct Frame {
+        NodeID vid;
+        // The step being matched and the times it's been repeated
+        uint32_t step;
+        uint32_t count;
+        T value;
+    };
+    const auto& steps = path.steps();
+    // A vertex at the given (step, count) of the path
+    using Position = std::pair<NodeID, uint64_t>;
+    auto match = [this, &steps, &init, &visit](NodeID src) {
+        std::vector<NodeID> ends;
+        std::unordered_set<Position, folly::hasher<Position>> visited;
+        std::vector<Frame> stack;
+        auto enter = [&visited, &stack](Frame&& frame) {
+            auto at = (uint64_t{frame.step} << 32) | frame.count;
+            if (visited.emplace(frame.vid, at).second) {
+                stack.push_back(std::move(frame));
+            }
+        };
+        enter(Frame{src, 0u, 0u, init(src)});
+        while (!stack.empty()) {
+            auto frame = std::move(stack.back());
+            stack.pop_back();
+            if (frame.step == steps.size()) {
+                ends.push_back(frame.vid);
+                continue;
+            }
+            const auto& step = steps[frame.step];
+            if (frame.count >= step.min && (frame.count - step.min) % step.stride == 0) {
+                enter(Frame{frame.vid, frame.step + 1, 0u, frame.value});
+            }
+            if (frame.count < step.max) {
+                for (auto nbr : neighborIDs(frame.vid, step.edges)) {
+                    if (!step.nodes.empty() && !hasNodeLabel(nbr, step.nodes)) continue;
+                    auto value = visit(frame.vid, nbr, frame.value);
+                    enter(Frame{nbr, frame.step, frame.count + 1, std::move(value)});
+                }
+            }
+        }
+        return ends;
+    };
+    auto* engine = ctx_->engine();
+    auto ends = engine->runOnCurrentThread(engine->parallelFor(sources.vids(), match));
+    std::vector<NodeID> vids;
+    for (auto& e : ends) {
+        vids.insert(vids.end(), e.begin(), e.end());
+    }
+    std::sort(vids.begin(), vids.end());
+    vids.erase(std::unique(vids.begin(), vids.end()), vids.end());
+    return VertexSubset(ctx_, std::move(vids));
+}
+
+template <typename StateType>
+template <typename Relax>
+size_t ComputingAlgorithm<StateType>::fixpoint(const VertexSubset& initial,
+                                               const LabelMask& edges,
+                                               Relax relax,
+                                               EdgeDirection dir) const {
+    auto* engine = ctx_->engine();
+    const auto& index = *vertexIndex_;
+    auto pullDir = reverse(dir);
+    // The vertices in the current frontier and the ones added to the next, by dense index
+    AtomicBitSet current(index.size()), next(index.size());
+
+    std::vector<NodeID> frontier;
+    for (auto vid : initial.vids()) {
+        auto idx = index.indexOf(vid);
+        if (idx != VertexIndex::kInvalidIndex && current.testAndSet(idx)) {
+            frontier.push_back(vid);
+        }
+    }
+
+    auto push = [this, &index, &edges, &relax, &next, dir](NodeID u) {
+        std::vector<NodeID> changed;
+        for (auto v : neighborIDs(u, edges, dir)) {
+            auto idx = index.indexOf(v);
+            if (idx != VertexIndex::kInvalidIndex && relax(u, v) && next.testAndSet(idx)) {
+                changed.push_back(v);
+            }
+        }
+        return changed;
+    };
+    auto pull = [this, &index, &edges, &relax, &current, &next, pullDir](
+                        NodeID v, std::vector<NodeID>& res) {
+        bool changed = false;
+        for (auto u : neighborIDs(v, edges, pullDir)) {
+            auto idx = index.indexOf(u);
+            if (idx != VertexIndex::kInvalidIndex && current.get(idx) && relax(u, v)) {
+                changed = true;
+            }
+        }
+        if (changed) {
+            next.testAndSet(index.indexOf(v));
+            res.push_back(v);
+        }
+    };
+
+    size_t rounds = 0;
+    while (!frontier.empty()) {
+        ++rounds;
+        std::vector<NodeID> updated;
+        if (frontier.size() > index.size() / kThresholdParam) {
+            updated = engine->runOnCurrentThread(engine->parallelFilter(index.vids(), pull));
+        } else {
+            auto res = engine->runOnCurrentThread(engine->parallelFor(frontier, push));
+            for (auto& vids : res) {
+                updated.insert(updated.end(), vids.begin(), vids.end());
+            }
+        }
+        // Only the bits of the frontier are set, reset them rather than the whole set
+        for (auto vid : frontier) {
+            current.reset(index.indexOf(vid));
+        }
+        std::swap(current, next);
+        frontier.swap(updated);
+    }
+    return rounds;
+}
+
+template <typename StateType>
+template <typename Pred, typename Sink>
+void ComputingAlgorithm<StateType>::streamResult(Pred pred, size_t batchSize, Sink sink) const {
+    constexpr uint32_t kChunkSize = 4096;
+    constexpr uint32_t kWindowSize = 64;
+    auto* engine = ctx_->engine();
+    auto numChunks = static_cast<uint32_t>((states_.size() + kChunkSize - 1) / kChunkSize);
+
+    auto buildRows = [this, &pred](uint32_t chunk) {
+        std::vector<Row> rows;
+        auto end = std::min<size_t>(states_.size(), (chunk + 1) * size_t{kChunkSize});
+        for (uint32_t idx = chunk * kChunkSize; idx < end; ++idx) {
+            if (!pred(states_[idx])) continue;
+            Row row;
+            row.append(vertexIndex_->vid(idx));
+            states_[idx].getResult(row);
+            rows.emplace_back(std::move(row));
+        }
+        return rows;
+    };
+
+    ResultTable batch;
+    for (uint32_t first = 0; first < numChunks; first += kWindowSize) {
+        std::vector<uint32_t> window(std::min(kWindowSize, numChunks - first));
+        std::iota(window.begin(), window.end(), first);
+        auto chunks = engine->runOnCurrentThread(engine->parallelFor(window, buildRows));
+        for (auto& rows : chunks) {
+            for (auto& row : rows) {
+                batch.getRecords().emplace_back(std::move(row));
+                if (batch.getNumRecords() >= batchSize) {
+                    sink(std::move(batch));
+                    batch.clear();
+                }
+            }
+        }
+    }
+    if (batch.getNumRecords() > 0) {
+        sink(std::move(batch));
+    }
+}
+
 }  // namespace nebula::computing
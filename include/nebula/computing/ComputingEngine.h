@@ -4,6 +4,9 @@
 
 #include <algorithm>
 #include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "nebula/common/base/Status.h"
 #include "nebula/common/thread/GenericThreadPool.h"
@@ -113,39 +116,19 @@ public:
             -> folly::SemiFuture<std::vector<R>>;
 
     /**
-     * @brief Use the thread pool to run the reduce on a container in parallel.
-     * @param container The container to be filtered.
-     * @param f The reduce function, must be thread-safe.
-     * @param rf The reduce function, must be thread-safe.
-     * @return The result of the future.
-     */
-    template <typename Container,
-              typename F,
-              typename T,
-              typename R = value_t<Container>,
-              typename RF = std::function<T(const T&, R)>>
-    auto parallelReduce(const Container& container, F f, RF rf)
-            -> folly::SemiFuture<std::vector<R>> {
-        using Iterator = decltype(std::begin(container));
-        return parallelReduce<Iterator, F, T, R, RF>(
-                std::begin(container), std::end(container), std::move(f), std::move(rf));
-    }
-
-    /**
-     * @brief Use the thread pool to run the reduce on a container in parallel.
-     * @param begin The begin iterator of the container.
-     * @param end The end iterator of the container.
-     * @param f The filter function, must be thread-safe.
-     * @param rf The reduce function, must be thread-safe.
-     * @return The result of the future.
+     * @brief Use the thread pool to reduce the values emitted per key in parallel. `f(v, emit)`
+     *  is called on each element, and calls `emit(key, value)` for the values to reduce. Each
+     *  task folds the values into its own partial result by `Combiner`, see `Combiner.h`,
+     *  then the partials are merged in the order of the tasks. The values of a key are
+     *  combined in the order of the container, so the result only depends on the number of
+     *  threads for the combiners which are not associative, e.g. a floating point sum.
+     * @param container The container to be reduced.
+     * @param f The emitting function, must be thread-safe.
+     * @return The reduced value of each key, in the order the keys are first emitted.
      */
-    template <typename Iterator,
-              typename F,
-              typename T,
-              typename R = value_t<Iterator>,
-              typename RF = std::function<T(const T&, R)>>
-    auto parallelReduce(Iterator begin, Iterator end, F f, RF rf)
-            -> folly::SemiFuture<std::vector<R>>;
+    template <typename Combiner, typename Key, typename Container, typename F>
+    auto parallelReduce(const Container& container, F&& f)
+            -> folly::SemiFuture<std::vector<std::pair<Key, typename Combiner::value_type>>>;
 
     thread::GenericThreadPool* threadPool() const {
         return threadPool_.get();
@@ -154,6 +137,19 @@ public:
     static constexpr size_t kParallelThreshold = 5000u;
 
 private:
+    template <typename Combiner, typename Key, typename T>
+    static void reduceInto(std::vector<std::pair<Key, T>>& partial,
+                           std::unordered_map<Key, size_t>& slots,
+                           const Key& key,
+                           T value) {
+        auto [iter, inserted] = slots.emplace(key, partial.size());
+        if (inserted) {
+            partial.emplace_back(key, std::move(value));
+        } else {
+            Combiner::combine(partial[iter->second].second, value);
+        }
+    }
+
     /**
      * @brief Split the range into tasks
      * @return the pair of the number of tasks and the size of each task
@@ -265,43 +261,41 @@ auto ComputingEngine::parallelFilter(Iterator begin, Iterator end, F&& f)
 }
 
 
-template <typename Iterator, typename F, typename T, typename R, typename RF>
-auto ComputingEngine::parallelReduce(Iterator begin, Iterator end, F f, RF rf)
-        -> folly::SemiFuture<std::vector<R>> {
+template <typename Combiner, typename Key, typename Container, typename F>
+auto ComputingEngine::parallelReduce(const Container& container, F&& f)
+        -> folly::SemiFuture<std::vector<std::pair<Key, typename Combiner::value_type>>> {
+    using T = typename Combiner::value_type;
+    using Partial = std::vector<std::pair<Key, T>>;
+    auto begin = std::begin(container);
+    auto end = std::end(container);
     auto [numTasks, step] = this->splitTasks(end - begin);
-    std::vector<folly::SemiFuture<std::vector<R>>> futures;
+    std::vector<folly::SemiFuture<Partial>> futures;
     for (size_t i = 0; i < numTasks; ++i) {
         auto from = begin + i * step;
         auto to = (from + step >= end ? end : from + step);
-        std::vector<typename Iterator::value_type> c(from, to);
-        auto future = threadPool_->addTask([c, f, rf]() {
-            std::vector<R> res;
-            std::unordered_map<R, std::vector<T>> tmp;
-            res.reserve(c.size());
-            tmp.reserve(c.size());
+        std::vector<value_t<Container>> c(from, to);
+        auto future = threadPool_->addTask([c, f]() {
+            Partial partial;
+            std::unordered_map<Key, size_t> slots;
+            auto emit = [&partial, &slots](const Key& key, T value) {
+                reduceInto<Combiner>(partial, slots, key, std::move(value));
+            };
             for (const auto& v : c) {
-                f(v, tmp, res);
-            }
-            for (const auto& v : res) {
-                // FIXME(yee): how to init the first value
-                T tnew;
-                for (const auto& t : tmp[v]) {
-                    tnew = rf(tnew, t);
-                }
+                f(v, emit);
             }
-            return res;
+            return partial;
         });
         futures.emplace_back(std::move(future));
     }
     return folly::collectAll(futures).deferValue([](auto&& res) {
-        std::vector<R> ret;
+        Partial merged;
+        std::unordered_map<Key, size_t> slots;
         for (auto& t : res) {
-            if (!t.hasException()) {
-                auto& v = t.value();
-                ret.insert(ret.end(), v.begin(), v.end());
+            for (auto& [key, value] : t.value()) {
+                reduceInto<Combiner>(merged, slots, key, std::move(value));
             }
         }
-        return ret;
+        return merged;
     });
 }
 
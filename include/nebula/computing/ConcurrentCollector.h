@@ -0,0 +1,79 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <folly/Likely.h>
+#include <folly/ThreadLocal.h>
+
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace nebula::computing {
+
+/**
+ * @brief ConcurrentCollector collects values from the parallel stages of an algorithm. Each
+ *  thread appends the values to its own buffer without any lock, in chunks of fixed capacity
+ *  so that they are never copied when the buffer grows, and the buffers are merged into one
+ *  vector once by `merge` at the end of the stage. The buffers are owned by the collector, so
+ *  the values outlive the threads which added them.
+ */
+template <typename T, size_t kChunkSize = 1024u>
+class ConcurrentCollector final {
+public:
+    void add(T value) {
+        auto*& buffer = *local_;
+        if (UNLIKELY(buffer == nullptr)) {
+            buffer = newBuffer();
+        }
+        auto& chunks = buffer->chunks;
+        if (chunks.empty() || chunks.back().size() == kChunkSize) {
+            chunks.emplace_back().reserve(kChunkSize);
+        }
+        chunks.back().emplace_back(std::move(value));
+    }
+
+    /**
+     * @brief Move the values buffered by all threads to the end of `values()`. It must not
+     *  run concurrently with `add`.
+     */
+    const std::vector<T>& merge() {
+        std::lock_guard<std::mutex> guard(buffersLock_);
+        for (auto& buffer : buffers_) {
+            for (auto& chunk : buffer->chunks) {
+                std::move(chunk.begin(), chunk.end(), std::back_inserter(values_));
+            }
+            buffer->chunks.clear();
+        }
+        return values_;
+    }
+
+    /**
+     * @brief The values merged so far.
+     */
+    const std::vector<T>& values() const {
+        return values_;
+    }
+
+private:
+    struct Buffer {
+        std::vector<std::vector<T>> chunks;
+    };
+
+    /**
+     * @brief Register the buffer of the calling thread, once per thread.
+     */
+    Buffer* newBuffer() {
+        std::lock_guard<std::mutex> guard(buffersLock_);
+        return buffers_.emplace_back(std::make_unique<Buffer>()).get();
+    }
+
+    // The buffer of each thread, nullptr until the thread adds its first value
+    folly::ThreadLocal<Buffer*> local_;
+    std::mutex buffersLock_;
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+    std::vector<T> values_;
+};
+
+}  // namespace nebula::computing
@@ -0,0 +1,82 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace nebula::computing {
+
+/**
+ * @brief DisjointSet is a lock-free union-find over the dense indices [0, size).
+ *  `find` and `unite` can be called concurrently from any number of threads. Roots are always
+ *  linked from the larger index to the smaller one, so the root of a set is the minimum index
+ *  in it no matter in which order the unions are applied. `find` compresses the path it walks
+ *  by path halving.
+ */
+class DisjointSet final {
+public:
+    explicit DisjointSet(size_t size)
+            : size_(size), parents_(std::make_unique<std::atomic<uint32_t>[]>(size)) {
+        for (size_t i = 0; i < size; ++i) {
+            parents_[i].store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+        }
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    /**
+     * @brief Find the root of the set which the given index belongs to.
+     */
+    uint32_t find(uint32_t idx) const {
+        while (true) {
+            auto parent = parents_[idx].load(std::memory_order_acquire);
+            if (parent == idx) {
+                return idx;
+            }
+            auto grand = parents_[parent].load(std::memory_order_acquire);
+            if (parent != grand) {
+                // Path halving, it's fine to lose the race since another thread has moved it
+                // closer to the root already.
+                parents_[idx].compare_exchange_weak(
+                        parent, grand, std::memory_order_release, std::memory_order_relaxed);
+            }
+            idx = grand;
+        }
+    }
+
+    /**
+     * @brief Merge the sets of the two given indices.
+     * @return true if the two indices were in different sets before.
+     */
+    bool unite(uint32_t a, uint32_t b) {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b) {
+                return false;
+            }
+            if (a < b) {
+                std::swap(a, b);
+            }
+            // Only a root could be linked, retry if `a` has been linked by another thread
+            uint32_t expected = a;
+            if (parents_[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel)) {
+                return true;
+            }
+        }
+    }
+
+    bool same(uint32_t a, uint32_t b) const {
+        return find(a) == find(b);
+    }
+
+private:
+    size_t size_{0u};
+    std::unique_ptr<std::atomic<uint32_t>[]> parents_;
+};
+
+}  // namespace nebula::computing
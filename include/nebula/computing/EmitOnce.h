@@ -0,0 +1,62 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <folly/concurrency/ConcurrentHashMap.h>
+
+#include <functional>
+#include <utility>
+
+namespace nebula::computing {
+
+/**
+ * @brief EmitOnce elects one candidate for each key from the parallel stages, so an output
+ *  derived by many vertices, e.g. the node of a bus derived by all of its CNs, is emitted
+ *  exactly once. Offering keeps the minimum candidate of the key by `Less`, so the elected one
+ *  is independent of the visiting order.
+ */
+template <typename Key,
+          typename Candidate,
+          typename Hash = std::hash<Key>,
+          typename Less = std::less<Candidate>>
+class EmitOnce final {
+public:
+    /**
+     * @brief Offer a candidate for the key, it's safe to call concurrently.
+     * @return true if it's the first offer of the key.
+     */
+    bool offer(const Key& key, const Candidate& candidate) {
+        auto [iter, inserted] = elected_.insert(key, candidate);
+        if (inserted) {
+            return true;
+        }
+        while (Less()(candidate, iter->second)) {
+            // Someone else may have replaced the current one, retry against the latest
+            if (elected_.assign_if_equal(key, iter->second, candidate)) {
+                break;
+            }
+            iter = elected_.find(key);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Call `f(const Key&, const Candidate&)` on the elected candidate of each key.
+     *  Don't call it while offering.
+     */
+    template <typename F>
+    void forEach(F&& f) const {
+        for (const auto& [key, candidate] : elected_) {
+            f(key, candidate);
+        }
+    }
+
+    size_t size() const {
+        return elected_.size();
+    }
+
+private:
+    folly::ConcurrentHashMap<Key, Candidate, Hash> elected_;
+};
+
+}  // namespace nebula::computing
@@ -0,0 +1,211 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <folly/Synchronized.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <set>
+#include <unordered_map>
+
+#include "nebula/common/utils/Types.h"
+
+namespace nebula::computing {
+
+/**
+ * @brief LabelMask is a set of interned labels, so that matching labels is a bitwise AND
+ *  instead of comparing strings. The labels which don't fit in the bits are kept as strings
+ *  and matched by comparing the strings.
+ */
+class LabelMask final {
+public:
+    static constexpr size_t kMaxLabels = 256u;
+
+    void set(uint32_t labelID) {
+        bits_.set(labelID);
+    }
+
+    bool test(uint32_t labelID) const {
+        return bits_.test(labelID);
+    }
+
+    /**
+     * @brief Add a label which can't be interned any more.
+     */
+    void addOverflow(const Label& label) {
+        auto labels = overflow_ ? std::make_shared<std::set<Label>>(*overflow_)
+                                : std::make_shared<std::set<Label>>();
+        labels->emplace(label);
+        overflow_ = std::move(labels);
+    }
+
+    bool empty() const {
+        return bits_.none() && !overflow_;
+    }
+
+    /**
+     * @brief Whether the two masks share any interned label.
+     */
+    bool intersects(const LabelMask& rhs) const {
+        return (bits_ & rhs.bits_).any();
+    }
+
+    /**
+     * @brief Whether any of the given labels is one of the labels which aren't interned.
+     */
+    bool overflowMatches(const std::set<Label>& labels) const {
+        if (!overflow_) {
+            return false;
+        }
+        for (const auto& label : labels) {
+            if (overflow_->count(label)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool hasOverflow() const {
+        return overflow_ != nullptr;
+    }
+
+    /**
+     * @brief Whether all labels of the given mask are in this mask.
+     */
+    bool contains(const LabelMask& rhs) const {
+        if (rhs.overflow_ && (!overflow_ || !std::includes(overflow_->begin(),
+                                                           overflow_->end(),
+                                                           rhs.overflow_->begin(),
+                                                           rhs.overflow_->end()))) {
+            return false;
+        }
+        return (bits_ & rhs.bits_) == rhs.bits_;
+    }
+
+    LabelMask& operator|=(const LabelMask& rhs) {
+        bits_ |= rhs.bits_;
+        if (rhs.overflow_) {
+            for (const auto& label : *rhs.overflow_) {
+                addOverflow(label);
+            }
+        }
+        return *this;
+    }
+
+    bool operator==(const LabelMask& rhs) const {
+        if (bits_ != rhs.bits_) {
+            return false;
+        }
+        if (!overflow_ || !rhs.overflow_) {
+            return overflow_ == rhs.overflow_;
+        }
+        return *overflow_ == *rhs.overflow_;
+    }
+
+private:
+    std::bitset<kMaxLabels> bits_;
+    // The labels which aren't interned, shared by the copies of the mask
+    std::shared_ptr<const std::set<Label>> overflow_;
+};
+
+/**
+ * @brief LabelInterner assigns a dense ID to each label to match, i.e. each label resolved by
+ *  `mask`. The labels of the node/edge types are only looked up by `typeMask`, the ones which
+ *  are never matched don't take an ID, so a graph can have any number of labels. It's thread
+ *  safe, but interning is expected to happen only when resolving the masks of the labels to
+ *  match.
+ */
+class LabelInterner final {
+public:
+    static constexpr uint32_t kNoID = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * @brief Intern the label.
+     * @return The ID of the label, or kNoID if all the IDs are taken.
+     */
+    uint32_t intern(const Label& label) {
+        auto id = find(label);
+        if (id != kNoID) {
+            return id;
+        }
+        auto ids = ids_.wlock();
+        auto iter = ids->find(label);
+        if (iter != ids->end()) {
+            return iter->second;
+        }
+        if (ids->size() >= LabelMask::kMaxLabels) {
+            LOG(WARNING) << "Too many labels to intern, match " << label << " as a string";
+            return kNoID;
+        }
+        id = static_cast<uint32_t>(ids->size());
+        ids->emplace(label, id);
+        size_.store(static_cast<uint32_t>(ids->size()), std::memory_order_release);
+        return id;
+    }
+
+    /**
+     * @brief The ID of the label, kNoID if it's not interned.
+     */
+    uint32_t find(const Label& label) const {
+        auto ids = ids_.rlock();
+        auto iter = ids->find(label);
+        return iter == ids->end() ? kNoID : iter->second;
+    }
+
+    /**
+     * @brief The number of interned labels, which only grows, so a mask built by `typeMask`
+     *  is up to date as long as it's the same.
+     */
+    uint32_t size() const {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief The mask of the labels to match.
+     */
+    template <typename Labels>
+    LabelMask mask(const Labels& labels) {
+        LabelMask m;
+        for (const auto& label : labels) {
+            auto id = intern(label);
+            if (id != kNoID) {
+                m.set(id);
+            } else {
+                m.addOverflow(label);
+            }
+        }
+        return m;
+    }
+
+    LabelMask mask(std::initializer_list<Label> labels) {
+        return mask<std::initializer_list<Label>>(labels);
+    }
+
+    /**
+     * @brief The mask of the labels of a node/edge type, with only the interned labels since
+     *  no mask to match has the others.
+     */
+    LabelMask typeMask(const std::set<Label>& labels) const {
+        LabelMask m;
+        for (const auto& label : labels) {
+            auto id = find(label);
+            if (id != kNoID) {
+                m.set(id);
+            }
+        }
+        return m;
+    }
+
+private:
+    folly::Synchronized<std::unordered_map<Label, uint32_t>> ids_;
+    std::atomic<uint32_t> size_{0};
+};
+
+}  // namespace nebula::computing
@@ -0,0 +1,47 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "nebula/computing/LabelMask.h"
+
+namespace nebula::computing {
+
+/**
+ * @brief LabelPath is a path pattern by the labels of its edges. Each step is an edge with
+ *  any label of the mask, repeated from `min` to `max` times by `stride`, and optionally
+ *  ends at a vertex with any label of `nodes`. E.g. the pattern `-[Breaker|Disconnector]{1,4}-
+ *  CN -[Bus_CN]- BUS` is `LabelPath{{switchLabel, 1, 4}, {busCNLabel, 1, 1, 1, busLabel}}`,
+ *  and `{disconnectorCNLabel, 0, 2, 2}` repeats the edge either 0 or 2 times, i.e. through
+ *  the disconnector to the CN on the other side of it or not at all.
+ */
+class LabelPath final {
+public:
+    struct Step {
+        LabelMask edges;
+        uint8_t min{1};
+        uint8_t max{1};
+        // The repeat counts matched are min, min + stride, ... up to max
+        uint8_t stride{1};
+        // Empty for any vertex
+        LabelMask nodes{};
+    };
+
+    LabelPath(std::initializer_list<Step> steps) : steps_(steps) {}
+
+    const std::vector<Step>& steps() const {
+        return steps_;
+    }
+
+    size_t size() const {
+        return steps_.size();
+    }
+
+private:
+    std::vector<Step> steps_;
+};
+
+}  // namespace nebula::computing
@@ -0,0 +1,67 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "nebula/common/datatype/Edge.h"
+#include "nebula/common/datatype/Value.h"
+#include "nebula/computing/ConcurrentCollector.h"
+
+namespace nebula::computing {
+
+/**
+ * @brief MutationLog keeps the node/edge writes flushed by an algorithm in memory instead of
+ *  applying them to the graph, for the runs whose output is returned to the caller rather
+ *  than stored. The writes are added from the tasks of the engine at flush.
+ */
+class MutationLog final {
+public:
+    struct Write {
+        std::string type;
+        // The primary keys of the endpoints, both empty for a node
+        std::vector<Value> srcPK;
+        std::vector<Value> dstPK;
+        properties_type props;
+
+        bool isNode() const {
+            return srcPK.empty() && dstPK.empty();
+        }
+    };
+
+    void addNode(const std::string& type, const properties_type& props) {
+        writes_.add(Write{type, {}, {}, props});
+    }
+
+    void addEdge(const std::string& type,
+                 const std::vector<Value>& srcPK,
+                 const std::vector<Value>& dstPK,
+                 const properties_type& props) {
+        writes_.add(Write{type, srcPK, dstPK, props});
+    }
+
+    void addUpdate(const Edge& edge) {
+        updates_.add(edge);
+    }
+
+    /**
+     * @brief The node/edge insertions, it must not run concurrently with a flush.
+     */
+    const std::vector<Write>& writes() {
+        return writes_.merge();
+    }
+
+    /**
+     * @brief The updates of the existing edges, it must not run concurrently with a flush.
+     */
+    const std::vector<Edge>& updates() {
+        return updates_.merge();
+    }
+
+private:
+    ConcurrentCollector<Write> writes_;
+    ConcurrentCollector<Edge> updates_;
+};
+
+}  // namespace nebula::computing
@@ -0,0 +1,397 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <folly/Likely.h>
+#include <folly/ThreadLocal.h>
+#include <folly/hash/Hash.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "nebula/common/datatype/Edge.h"
+#include "nebula/common/datatype/Value.h"
+#include "nebula/common/graph/GraphTraits.h"
+#include "nebula/computing/ComputingEngine.h"
+
+namespace nebula::computing {
+
+/**
+ * @brief EdgePair is a symmetric edge written in both directions. It keeps the record of the
+ *  forward edge and only the overlay of the properties which differ in the backward one, which
+ *  is built by `Record::reversed(const Overlay&)` when the pair is written.
+ */
+template <typename Record, typename Overlay>
+struct EdgePair {
+    Record forward;
+    Overlay backward;
+
+    bool operator==(const EdgePair& rhs) const {
+        return forward == rhs.forward && backward == rhs.backward;
+    }
+
+    size_t hash() const {
+        return folly::hash::hash_combine(forward.hash(), backward.hash());
+    }
+};
+
+/**
+ * @brief MutationSink buffers the node/edge writes issued from the parallel stages of an
+ *  algorithm and applies them in bulk at `flush`. The writes are appended to the buffer of the
+ *  calling thread, grouped by node/edge type as columns, so issuing a write is a lock-free
+ *  append. At `flush` the identical writes are removed and the rest of each type is handed
+ *  to the writers in batches of at most kBatchSize rows, one call per batch, so a writer
+ *  backed by a bulk write commits each batch at once. Since the writes are deferred, the
+ *  algorithm must flush before it reads back what it has written from the graph.
+ */
+class MutationSink final {
+public:
+    using NodeRows = std::vector<properties_type>;
+
+    /**
+     * @brief The rows of an edge type as columns.
+     */
+    struct EdgeRows {
+        std::vector<std::vector<Value>> srcPKs;
+        std::vector<std::vector<Value>> dstPKs;
+        std::vector<properties_type> props;
+
+        size_t size() const {
+            return props.size();
+        }
+
+        void add(std::vector<Value> srcPK, std::vector<Value> dstPK, properties_type p) {
+            srcPKs.emplace_back(std::move(srcPK));
+            dstPKs.emplace_back(std::move(dstPK));
+            props.emplace_back(std::move(p));
+        }
+
+        void append(EdgeRows&& rhs) {
+            std::move(rhs.srcPKs.begin(), rhs.srcPKs.end(), std::back_inserter(srcPKs));
+            std::move(rhs.dstPKs.begin(), rhs.dstPKs.end(), std::back_inserter(dstPKs));
+            std::move(rhs.props.begin(), rhs.props.end(), std::back_inserter(props));
+        }
+    };
+
+    // Each writer is called once per batch of rows of one type, on the thread of `flush`
+    using NodeWriter = std::function<void(const std::string&, const NodeRows&)>;
+    using EdgeWriter = std::function<void(const std::string&, const EdgeRows&)>;
+    using EdgeUpdater = std::function<void(const std::vector<Edge>&)>;
+
+    // The max number of rows handed to a writer at once
+    static constexpr size_t kBatchSize = 4096u;
+
+    MutationSink(ComputingEngine* engine,
+                 NodeWriter nodeWriter,
+                 EdgeWriter edgeWriter,
+                 EdgeUpdater edgeUpdater)
+            : engine_(engine),
+              nodeWriter_(std::move(nodeWriter)),
+              edgeWriter_(std::move(edgeWriter)),
+              edgeUpdater_(std::move(edgeUpdater)) {}
+
+    /**
+     * @brief Replace the writers the buffered writes are applied with, e.g. to keep them in
+     *  memory. It must not run concurrently with `flush`.
+     */
+    void redirect(NodeWriter nodeWriter, EdgeWriter edgeWriter, EdgeUpdater edgeUpdater) {
+        nodeWriter_ = std::move(nodeWriter);
+        edgeWriter_ = std::move(edgeWriter);
+        edgeUpdater_ = std::move(edgeUpdater);
+    }
+
+    void insertNode(const std::string& type, properties_type props) {
+        localBuffer().nodes[type].emplace_back(std::move(props));
+    }
+
+    void insertEdge(const std::string& type,
+                    std::vector<Value> srcPK,
+                    std::vector<Value> dstPK,
+                    properties_type props = {}) {
+        localBuffer().edges[type].add(std::move(srcPK), std::move(dstPK), std::move(props));
+    }
+
+    /**
+     * @brief Buffer an edge as a typed record instead of a property map, the map is only
+     *  built by `Record::properties` when the edge is written at `flush`. `Record` provides
+     *  `srcPK()`, `dstPK()`, `properties()`, `hash()` and `operator==`. The records are
+     *  batched by the edge type and the record type together.
+     */
+    template <typename Record>
+    void insertEdgeRecord(const std::string& type, Record record) {
+        auto& batch = localBuffer().records[RecordKey{type, typeid(Record)}];
+        if (!batch) {
+            batch = std::make_unique<RecordBatch<Record>>();
+        }
+        static_cast<RecordBatch<Record>*>(batch.get())->rows.emplace_back(std::move(record));
+    }
+
+    /**
+     * @brief Buffer a symmetric edge in both directions as one record and the overlay of the
+     *  backward edge, see `EdgePair`.
+     */
+    template <typename Record, typename Overlay>
+    void insertEdgePair(const std::string& type, Record forward, Overlay backward) {
+        using Pair = EdgePair<Record, Overlay>;
+        insertEdgeRecord(type, Pair{std::move(forward), std::move(backward)});
+    }
+
+    void updateEdge(Edge edge) {
+        localBuffer().updates.emplace_back(std::move(edge));
+    }
+
+    /**
+     * @brief Apply all buffered writes, it must not be called from the tasks of the engine
+     *  nor run concurrently with the inserts.
+     * @return The number of writes applied after removing duplicates.
+     */
+    size_t flush() {
+        std::unordered_map<std::string, NodeRows> nodes;
+        std::unordered_map<std::string, EdgeRows> edges;
+        std::map<RecordKey, std::unique_ptr<RecordBatchBase>> records;
+        std::vector<Edge> updates;
+        {
+            std::lock_guard<std::mutex> guard(buffersLock_);
+            for (auto& buffer : buffers_) {
+                for (auto& [type, rows] : buffer->nodes) {
+                    auto& merged = nodes[type];
+                    std::move(rows.begin(), rows.end(), std::back_inserter(merged));
+                }
+                for (auto& [type, rows] : buffer->edges) {
+                    edges[type].append(std::move(rows));
+                }
+                for (auto& [key, batch] : buffer->records) {
+                    auto& merged = records[key];
+                    if (!merged) {
+                        merged = std::move(batch);
+                    } else {
+                        merged->append(std::move(*batch));
+                    }
+                }
+                std::move(buffer->updates.begin(),
+                          buffer->updates.end(),
+                          std::back_inserter(updates));
+                buffer->nodes.clear();
+                buffer->edges.clear();
+                buffer->records.clear();
+                buffer->updates.clear();
+            }
+        }
+
+        // The structured bindings can't be captured by the lambdas, hence the entries
+        size_t applied = 0;
+        for (auto& entry : nodes) {
+            const auto& type = entry.first;
+            auto& rows = entry.second;
+            auto distinctRows = distinctNodes(rows);
+            forEachBatch(distinctRows.size(), [&](size_t first, size_t last) {
+                NodeRows batch;
+                batch.reserve(last - first);
+                for (auto i = first; i < last; ++i) {
+                    batch.emplace_back(std::move(rows[distinctRows[i]]));
+                }
+                nodeWriter_(type, batch);
+            });
+            applied += distinctRows.size();
+        }
+        for (auto& entry : edges) {
+            const auto& type = entry.first;
+            auto& rows = entry.second;
+            auto distinctRows = distinctEdges(rows);
+            forEachBatch(distinctRows.size(), [&](size_t first, size_t last) {
+                EdgeRows batch;
+                for (auto i = first; i < last; ++i) {
+                    auto row = distinctRows[i];
+                    batch.add(std::move(rows.srcPKs[row]),
+                              std::move(rows.dstPKs[row]),
+                              std::move(rows.props[row]));
+                }
+                edgeWriter_(type, batch);
+            });
+            applied += distinctRows.size();
+        }
+        for (auto& [key, batch] : records) {
+            applied += batch->apply(*this, key.first);
+        }
+        auto distinctRows = distinctUpdates(updates);
+        forEachBatch(distinctRows.size(), [&](size_t first, size_t last) {
+            std::vector<Edge> batch;
+            batch.reserve(last - first);
+            for (auto i = first; i < last; ++i) {
+                batch.emplace_back(std::move(updates[distinctRows[i]]));
+            }
+            edgeUpdater_(batch);
+        });
+        applied += distinctRows.size();
+        return applied;
+    }
+
+private:
+    // The records are batched by the edge type and the record type
+    using RecordKey = std::pair<std::string, std::type_index>;
+
+    static size_t hashProps(const properties_type& props) {
+        // The order of the properties is unspecified, so combine them commutatively
+        size_t h = props.size();
+        for (const auto& [name, value] : props) {
+            h += folly::hash::hash_combine(std::hash<String>()(name),
+                                           std::hash<Value>()(value));
+        }
+        return h;
+    }
+
+    static size_t hashPK(const std::vector<Value>& pk) {
+        size_t h = pk.size();
+        for (const auto& v : pk) {
+            h = folly::hash::hash_combine(h, std::hash<Value>()(v));
+        }
+        return h;
+    }
+
+    /**
+     * @brief Get the first row of each group of equal rows in [0, n).
+     */
+    template <typename Hash, typename Equal>
+    static std::vector<size_t> distinct(size_t n, Hash hash, Equal equal) {
+        std::unordered_set<size_t, Hash, Equal> seen(n, hash, equal);
+        std::vector<size_t> rows;
+        for (size_t row = 0; row < n; ++row) {
+            if (seen.emplace(row).second) {
+                rows.push_back(row);
+            }
+        }
+        return rows;
+    }
+
+    static std::vector<size_t> distinctNodes(const NodeRows& rows) {
+        auto hash = [&rows](size_t row) { return hashProps(rows[row]); };
+        auto equal = [&rows](size_t l, size_t r) { return rows[l] == rows[r]; };
+        return distinct(rows.size(), hash, equal);
+    }
+
+    static std::vector<size_t> distinctEdges(const EdgeRows& rows) {
+        auto hash = [&rows](size_t row) {
+            return folly::hash::hash_combine(hashPK(rows.srcPKs[row]),
+                                             hashPK(rows.dstPKs[row]),
+                                             hashProps(rows.props[row]));
+        };
+        auto equal = [&rows](size_t l, size_t r) {
+            return rows.srcPKs[l] == rows.srcPKs[r] && rows.dstPKs[l] == rows.dstPKs[r] &&
+                   rows.props[l] == rows.props[r];
+        };
+        return distinct(rows.size(), hash, equal);
+    }
+
+    static std::vector<size_t> distinctUpdates(const std::vector<Edge>& updates) {
+        auto hash = [&updates](size_t row) {
+            const auto& edge = updates[row];
+            return folly::hash::hash_combine(GraphTraits::EdgeIDHash()(edge.getEdgeID()),
+                                             hashProps(edge.properties()));
+        };
+        auto equal = [&updates](size_t l, size_t r) {
+            return GraphTraits::EdgeIDEqual()(updates[l].getEdgeID(), updates[r].getEdgeID()) &&
+                   updates[l].properties() == updates[r].properties();
+        };
+        return distinct(updates.size(), hash, equal);
+    }
+
+    /**
+     * @brief Call `apply(first, last)` on each batch of the rows [0, n), in order.
+     */
+    template <typename Apply>
+    static void forEachBatch(size_t n, Apply&& apply) {
+        for (size_t first = 0; first < n; first += kBatchSize) {
+            apply(first, std::min(n, first + kBatchSize));
+        }
+    }
+
+    struct RecordBatchBase {
+        virtual ~RecordBatchBase() = default;
+        virtual void append(RecordBatchBase&& rhs) = 0;
+        virtual size_t apply(const MutationSink& sink, const std::string& type) const = 0;
+    };
+
+    template <typename Record>
+    struct RecordBatch final : RecordBatchBase {
+        std::vector<Record> rows;
+
+        void append(RecordBatchBase&& rhs) override {
+            auto& other = static_cast<RecordBatch&>(rhs).rows;
+            std::move(other.begin(), other.end(), std::back_inserter(rows));
+        }
+
+        size_t apply(const MutationSink& sink, const std::string& type) const override {
+            auto hash = [this](size_t row) { return rows[row].hash(); };
+            auto equal = [this](size_t l, size_t r) { return rows[l] == rows[r]; };
+            auto distinctRows = distinct(rows.size(), hash, equal);
+            // The property maps are the expensive part, so the rows of a batch are built in
+            // parallel before it's handed to the writer
+            auto toRows = [this](size_t row) {
+                EdgeRows out;
+                MutationSink::addRows(out, rows[row]);
+                return out;
+            };
+            auto engine = sink.engine_;
+            size_t applied = 0;
+            forEachBatch(distinctRows.size(), [&](size_t first, size_t last) {
+                auto begin = distinctRows.begin() + first;
+                auto built = engine->runOnCurrentThread(
+                        engine->parallelFor(begin, distinctRows.begin() + last, toRows));
+                EdgeRows batch;
+                for (auto& rs : built) {
+                    batch.append(std::move(rs));
+                }
+                sink.edgeWriter_(type, batch);
+                applied += batch.size();
+            });
+            return applied;
+        }
+    };
+
+    template <typename Record>
+    static void addRows(EdgeRows& out, const Record& rec) {
+        out.add(rec.srcPK(), rec.dstPK(), rec.properties());
+    }
+
+    template <typename Record, typename Overlay>
+    static void addRows(EdgeRows& out, const EdgePair<Record, Overlay>& pair) {
+        addRows(out, pair.forward);
+        addRows(out, pair.forward.reversed(pair.backward));
+    }
+
+    struct Buffer {
+        std::unordered_map<std::string, NodeRows> nodes;
+        std::unordered_map<std::string, EdgeRows> edges;
+        std::map<RecordKey, std::unique_ptr<RecordBatchBase>> records;
+        std::vector<Edge> updates;
+    };
+
+    Buffer& localBuffer() {
+        auto*& buffer = *local_;
+        if (UNLIKELY(buffer == nullptr)) {
+            std::lock_guard<std::mutex> guard(buffersLock_);
+            buffer = buffers_.emplace_back(std::make_unique<Buffer>()).get();
+        }
+        return *buffer;
+    }
+
+    ComputingEngine* engine_{nullptr};
+    NodeWriter nodeWriter_;
+    EdgeWriter edgeWriter_;
+    EdgeUpdater edgeUpdater_;
+    // The buffer of each thread, nullptr until the thread issues its first write
+    folly::ThreadLocal<Buffer*> local_;
+    std::mutex buffersLock_;
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+};
+
+}  // namespace nebula::computing
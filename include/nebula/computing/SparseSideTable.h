@@ -0,0 +1,94 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "nebula/common/utils/Types.h"
+
+namespace nebula::computing {
+
+/**
+ * @brief SparseSideTable holds the per-vertex payloads which only a few vertices have, so they
+ *  don't bloat the state of every vertex. It's keyed by the vid rather than the dense index
+ *  of `VertexIndex`, so the vertices inserted by the algorithm, which aren't indexed, have
+ *  their own entries too. The entry is allocated when a vertex is updated for the first
+ *  time. The table is sharded by vid and each shard has its own lock, so it's safe to update
+ *  it in parallel.
+ */
+template <typename T>
+class SparseSideTable final {
+public:
+    static constexpr size_t kDefaultShards = 64u;
+
+    explicit SparseSideTable(size_t numShards = kDefaultShards)
+            : numShards_(numShards), shards_(std::make_unique<Shard[]>(numShards)) {}
+
+    /**
+     * @brief Call `f(T&)` on the entry of the given vertex under the lock of its shard, the
+     *  entry is created if it doesn't exist.
+     */
+    template <typename F>
+    void update(NodeID vid, F&& f) {
+        auto& shard = shardOf(vid);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        f(shard.entries[vid]);
+    }
+
+    /**
+     * @brief Call `f(const T&)` on the entry of the given vertex under the lock of its shard.
+     * @return false if the entry doesn't exist.
+     */
+    template <typename F>
+    bool read(NodeID vid, F&& f) const {
+        auto& shard = shardOf(vid);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto iter = shard.entries.find(vid);
+        if (iter == shard.entries.end()) {
+            return false;
+        }
+        f(iter->second);
+        return true;
+    }
+
+    /**
+     * @brief Get the entry of the given vertex, nullptr if it doesn't exist. It doesn't lock,
+     *  so don't call it while the table is updated.
+     */
+    const T* find(NodeID vid) const {
+        const auto& entries = shardOf(vid).entries;
+        auto iter = entries.find(vid);
+        return iter == entries.end() ? nullptr : &iter->second;
+    }
+
+    /**
+     * @brief The number of vertices which have an entry.
+     */
+    size_t size() const {
+        size_t n = 0;
+        for (size_t i = 0; i < numShards_; ++i) {
+            std::lock_guard<std::mutex> guard(shards_[i].lock);
+            n += shards_[i].entries.size();
+        }
+        return n;
+    }
+
+private:
+    struct Shard {
+        mutable std::mutex lock;
+        std::unordered_map<NodeID, T> entries;
+    };
+
+    // The low bits of a vid are its sequence ID, which spreads the vertices over the shards
+    Shard& shardOf(NodeID vid) const {
+        return shards_[static_cast<uint64_t>(vid) % numShards_];
+    }
+
+    size_t numShards_{0u};
+    std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace nebula::computing
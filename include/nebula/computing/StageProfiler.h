@@ -0,0 +1,146 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace nebula::computing {
+
+/**
+ * @brief StageProfiler measures the named stages of an algorithm: the wall and CPU time, the
+ *  sizes of the input and output frontiers, and the edges scanned, properties read and
+ *  mutations emitted during each stage. The stages are delimited by `lap` on the driving
+ *  thread. It's disabled by default, then counting costs a single branch. The counters are
+ *  sharded by thread so that the parallel stages don't contend on them.
+ */
+class StageProfiler final {
+public:
+    enum Counter : size_t {
+        kEdgesScanned = 0,
+        kPropertyReads,
+        kMutations,
+        kNumCounters,
+    };
+
+    struct StageStats {
+        std::string name;
+        int64_t wallUs{0};
+        // The CPU time of all threads of the process, including the workers of the engine
+        int64_t cpuUs{0};
+        int64_t inputSize{0};
+        int64_t outputSize{0};
+        int64_t counters[kNumCounters]{};
+    };
+
+    static constexpr size_t kNumShards = 64u;
+
+    StageProfiler() : shards_(std::make_unique<Shard[]>(kNumShards)) {}
+
+    /**
+     * @brief Enable or disable the profiler, it must not be switched while a stage runs.
+     */
+    void enable(bool enabled) {
+        enabled_ = enabled;
+    }
+
+    bool enabled() const {
+        return enabled_;
+    }
+
+    void count(Counter counter, uint64_t n = 1u) const {
+        if (!enabled_) {
+            return;
+        }
+        localShard().counters[counter].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Start the first stage and drop the stages recorded before.
+     */
+    void start() {
+        if (!enabled_) {
+            return;
+        }
+        stages_.clear();
+        mark_ = now();
+    }
+
+    /**
+     * @brief End the current stage and start the next one. A stage spans from the previous
+     *  `lap` or `start` on the driving thread, so the stages of a pipeline add up to its
+     *  total time.
+     */
+    void lap(const char* name, size_t inputSize, size_t outputSize = 0u) {
+        if (!enabled_) {
+            return;
+        }
+        auto mark = now();
+        StageStats stats;
+        stats.name = name;
+        auto wall = mark.wall - mark_.wall;
+        stats.wallUs = std::chrono::duration_cast<std::chrono::microseconds>(wall).count();
+        stats.cpuUs = mark.cpuUs - mark_.cpuUs;
+        stats.inputSize = static_cast<int64_t>(inputSize);
+        stats.outputSize = static_cast<int64_t>(outputSize);
+        for (size_t c = 0; c < kNumCounters; ++c) {
+            stats.counters[c] = mark.counters[c] - mark_.counters[c];
+        }
+        stages_.emplace_back(std::move(stats));
+        mark_ = mark;
+    }
+
+    const std::vector<StageStats>& stages() const {
+        return stages_;
+    }
+
+private:
+    struct Mark {
+        std::chrono::steady_clock::time_point wall;
+        int64_t cpuUs{0};
+        int64_t counters[kNumCounters]{};
+    };
+
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> counters[kNumCounters]{};
+    };
+
+    Shard& localShard() const {
+        return shards_[std::hash<std::thread::id>()(std::this_thread::get_id()) % kNumShards];
+    }
+
+    int64_t total(Counter counter) const {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kNumShards; ++i) {
+            sum += shards_[i].counters[counter].load(std::memory_order_relaxed);
+        }
+        return static_cast<int64_t>(sum);
+    }
+
+    Mark now() const {
+        Mark mark;
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        mark.cpuUs = static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+        for (size_t c = 0; c < kNumCounters; ++c) {
+            mark.counters[c] = total(static_cast<Counter>(c));
+        }
+        mark.wall = std::chrono::steady_clock::now();
+        return mark;
+    }
+
+    bool enabled_{false};
+    std::unique_ptr<Shard[]> shards_;
+    Mark mark_;
+    std::vector<StageStats> stages_;
+};
+
+}  // namespace nebula::computing
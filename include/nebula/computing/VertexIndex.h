@@ -0,0 +1,112 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "nebula/common/utils/Types.h"
+#include "nebula/common/utils/Utils.h"
+
+namespace nebula::computing {
+
+/**
+ * @brief VertexIndex maps the vertices of a graph to the dense indices [0, size), so that the
+ *  per-vertex data can be kept in contiguous arrays. It's immutable once built.
+ *
+ *  The vids are grouped by their node type and bucket, the high 32 bits, and the sequence IDs
+ *  of a group are mostly contiguous, so each group maps them by an array offset from the
+ *  smallest one. `indexOf` is a lookup in the small table of groups plus an array load rather
+ *  than a probe of a map with an entry per vertex. A group whose sequence IDs are too sparse
+ *  for an array falls back to a map.
+ */
+class VertexIndex final {
+public:
+    static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+    VertexIndex() = default;
+
+    explicit VertexIndex(std::vector<NodeID> vids) : vids_(std::move(vids)) {
+        for (auto vid : vids_) {
+            auto &group = groups_[groupOf(vid)];
+            auto seq = NodeIDUtils::nodeSeqID(vid);
+            group.first = std::min(group.first, seq);
+            group.last = std::max(group.last, seq);
+            ++group.count;
+        }
+        for (auto &[key, group] : groups_) {
+            size_t span = size_t{group.last} - group.first + 1;
+            if (span <= kMaxSpanPerVertex * group.count) {
+                group.dense.assign(span, kInvalidIndex);
+            }
+        }
+        for (size_t i = 0; i < vids_.size(); ++i) {
+            auto &group = groups_.at(groupOf(vids_[i]));
+            auto seq = NodeIDUtils::nodeSeqID(vids_[i]);
+            if (!group.dense.empty()) {
+                group.dense[seq - group.first] = static_cast<uint32_t>(i);
+            } else {
+                group.sparse.emplace(seq, static_cast<uint32_t>(i));
+            }
+        }
+    }
+
+    size_t size() const {
+        return vids_.size();
+    }
+
+    /**
+     * @brief Get the dense index of the given vertex, `kInvalidIndex` if it's not indexed.
+     */
+    uint32_t indexOf(NodeID vid) const {
+        auto iter = groups_.find(groupOf(vid));
+        if (iter == groups_.end()) {
+            return kInvalidIndex;
+        }
+        return iter->second.indexOf(NodeIDUtils::nodeSeqID(vid));
+    }
+
+    NodeID vid(uint32_t idx) const {
+        return vids_[idx];
+    }
+
+    const std::vector<NodeID>& vids() const {
+        return vids_;
+    }
+
+private:
+    // The array of a group is used if it has at most this many slots per vertex
+    static constexpr size_t kMaxSpanPerVertex = 4;
+
+    /**
+     * @brief The vertices of a node type in a bucket.
+     */
+    struct Group {
+        NodeSeqID first{std::numeric_limits<NodeSeqID>::max()};
+        NodeSeqID last{0};
+        size_t count{0};
+        // The dense index of each sequence ID from `first`, empty if the group is sparse
+        std::vector<uint32_t> dense;
+        std::unordered_map<NodeSeqID, uint32_t> sparse;
+
+        uint32_t indexOf(NodeSeqID seq) const {
+            if (!dense.empty()) {
+                return seq < first || seq > last ? kInvalidIndex : dense[seq - first];
+            }
+            auto iter = sparse.find(seq);
+            return iter == sparse.end() ? kInvalidIndex : iter->second;
+        }
+    };
+
+    static uint32_t groupOf(NodeID vid) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(vid) >> 32);
+    }
+
+    std::vector<NodeID> vids_;
+    std::unordered_map<uint32_t, Group> groups_;
+};
+
+}  // namespace nebula::computing
@@ -2,16 +2,17 @@
 
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <vector>
 
 #include "nebula/common/utils/Utils.h"
 #include "nebula/computing/BitSet.h"
+#include "nebula/computing/ComputingContext.h"
+#include "nebula/computing/ComputingEngine.h"
 
 namespace nebula::computing {
 
-class ComputingContext;
-
 using VertexFilterFn = std::function<bool(NodeID)>;
 using VertexActionFn = std::function<void(NodeID)>;
 using VertexMapFn = std::function<std::vector<NodeID>(NodeID)>;
@@ -63,6 +64,49 @@ public:
      */
     VertexSubset map(VertexMapFn&& m) const;
 
+    /**
+     * @brief The counterparts of `filter`/`forEach`/`map` taking any callable instead of a
+     *  `std::function`, so that it's inlined into the loop over the vertices rather than called
+     *  indirectly per vertex. They are picked for lambdas, and the `std::function` overloads
+     *  are kept for the callers passing one.
+     */
+    template <typename F>
+    VertexSubset filter(F&& f) const {
+        auto* engine = ctx_->engine();
+        auto future = engine->parallelFilter(vids_, [&f](NodeID vid, std::vector<NodeID>& res) {
+            if (f(vid)) {
+                res.push_back(vid);
+            }
+        });
+        return VertexSubset(ctx_, engine->runOnCurrentThread(std::move(future)));
+    }
+
+    template <typename F>
+    VertexSubset& forEach(F&& action) {
+        auto* engine = ctx_->engine();
+        engine->runOnCurrentThread(engine->parallelFor(vids_, [&action](NodeID vid) {
+            action(vid);
+        }));
+        return *this;
+    }
+
+    /**
+     * @brief The vertices mapped to are deduplicated, and returned in the order of their IDs.
+     */
+    template <typename F>
+    VertexSubset map(F&& m) const {
+        auto* engine = ctx_->engine();
+        auto res = engine->runOnCurrentThread(
+                engine->parallelFor(vids_, [&m](NodeID vid) { return m(vid); }));
+        std::vector<NodeID> vids;
+        for (auto& v : res) {
+            vids.insert(vids.end(), v.begin(), v.end());
+        }
+        std::sort(vids.begin(), vids.end());
+        vids.erase(std::unique(vids.begin(), vids.end()), vids.end());
+        return VertexSubset(ctx_, std::move(vids));
+    }
+
     bool isIn(NodeID vid) const {
         return vid2idx_.count(vid);
     }
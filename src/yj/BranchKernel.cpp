@@ -0,0 +1,129 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#include "yj/BranchKernel.h"
+
+#include <cmath>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace yj {
+
+namespace {
+
+const double kSqrt3 = std::sqrt(3.0);
+
+// The limits of the branches rated below it are not set
+constexpr double kMinLimit = 0.1;
+constexpr double kNoLimit = 9999;
+
+/**
+ * @brief The kernel on [begin, end). The expressions keep the evaluation order of the
+ *  per-edge code they replace, so that the vectorized lanes round the same way.
+ */
+void computeScalar(BranchParams *p, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        auto r = p->r[i], x = p->x[i], volt = p->volt[i], ih = p->ih[i], s = p->s[i];
+        auto z2 = r * r + x * x;
+        p->g[i] = std::abs(r) / z2;
+        p->b[i] = x / z2;
+        p->bij[i] = 1 / x;
+        auto normal = kSqrt3 * volt * ih / 1000 / 100 + s / 100;
+        if (normal < kMinLimit) {
+            p->lineQ1[i] = p->lineQ2[i] = p->lineQ3[i] = kNoLimit;
+        } else {
+            p->lineQ1[i] = normal;
+            p->lineQ2[i] = 1.1 * kSqrt3 * volt * ih / 1000 / 100 + 1.1 * (s / 100);
+            p->lineQ3[i] = 1.2 * kSqrt3 * volt * ih / 1000 / 100 + 1.2 * (s / 100);
+        }
+        p->reverse[i] = p->from[i] < p->to[i] ? -1 : 1;
+    }
+}
+
+#if defined(__x86_64__)
+
+// k * volt * ih / 1000 / 100, the rating of a line in p.u. for k = sqrt(3)
+__attribute__((target("avx2"))) inline __m256d lineRating(
+        __m256d k, __m256d volt, __m256d ih, __m256d c1000, __m256d c100) {
+    return _mm256_div_pd(_mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(k, volt), ih), c1000), c100);
+}
+
+// No FMA, a fused multiply-add would round differently from the scalar kernel
+__attribute__((target("avx2"))) size_t computeAVX2(BranchParams *p) {
+    constexpr size_t kLanes = 4;
+    auto n = p->size() / kLanes * kLanes;
+
+    auto sqrt3 = _mm256_set1_pd(kSqrt3);
+    auto emerSqrt3 = _mm256_set1_pd(1.1 * kSqrt3);
+    auto ldshdSqrt3 = _mm256_set1_pd(1.2 * kSqrt3);
+    auto c1000 = _mm256_set1_pd(1000);
+    auto c100 = _mm256_set1_pd(100);
+    auto c11 = _mm256_set1_pd(1.1);
+    auto c12 = _mm256_set1_pd(1.2);
+    auto one = _mm256_set1_pd(1);
+    auto minLimit = _mm256_set1_pd(kMinLimit);
+    auto noLimit = _mm256_set1_pd(kNoLimit);
+    auto signMask = _mm256_set1_pd(-0.0);
+    auto oneI = _mm256_set1_epi64x(1);
+    auto lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+
+    for (size_t i = 0; i < n; i += kLanes) {
+        auto r = _mm256_loadu_pd(&p->r[i]);
+        auto x = _mm256_loadu_pd(&p->x[i]);
+        auto volt = _mm256_loadu_pd(&p->volt[i]);
+        auto ih = _mm256_loadu_pd(&p->ih[i]);
+        auto s = _mm256_loadu_pd(&p->s[i]);
+
+        auto z2 = _mm256_add_pd(_mm256_mul_pd(r, r), _mm256_mul_pd(x, x));
+        _mm256_storeu_pd(&p->g[i], _mm256_div_pd(_mm256_andnot_pd(signMask, r), z2));
+        _mm256_storeu_pd(&p->b[i], _mm256_div_pd(x, z2));
+        _mm256_storeu_pd(&p->bij[i], _mm256_div_pd(one, x));
+
+        auto tx = _mm256_div_pd(s, c100);
+        auto normal = _mm256_add_pd(lineRating(sqrt3, volt, ih, c1000, c100), tx);
+        auto emer = _mm256_add_pd(lineRating(emerSqrt3, volt, ih, c1000, c100),
+                                  _mm256_mul_pd(c11, tx));
+        auto ldshd = _mm256_add_pd(lineRating(ldshdSqrt3, volt, ih, c1000, c100),
+                                   _mm256_mul_pd(c12, tx));
+        auto unset = _mm256_cmp_pd(normal, minLimit, _CMP_LT_OQ);
+        _mm256_storeu_pd(&p->lineQ1[i], _mm256_blendv_pd(normal, noLimit, unset));
+        _mm256_storeu_pd(&p->lineQ2[i], _mm256_blendv_pd(emer, noLimit, unset));
+        _mm256_storeu_pd(&p->lineQ3[i], _mm256_blendv_pd(ldshd, noLimit, unset));
+
+        auto from = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&p->from[i]));
+        auto to = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&p->to[i]));
+        // All ones, i.e. -1, where from < to, and 1 elsewhere
+        auto reverse = _mm256_or_si256(_mm256_cmpgt_epi64(to, from), oneI);
+        reverse = _mm256_permutevar8x32_epi32(reverse, lowHalves);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&p->reverse[i]),
+                         _mm256_castsi256_si128(reverse));
+    }
+    return n;
+}
+
+#endif
+
+}  // namespace
+
+void BranchParams::resize(size_t n) {
+    for (auto *v : {&r, &x, &volt, &ih, &s, &g, &b, &bij, &lineQ1, &lineQ2, &lineQ3}) {
+        v->resize(n);
+    }
+    from.resize(n);
+    to.resize(n);
+    reverse.resize(n);
+}
+
+void computeBranchParams(BranchParams *params) {
+    size_t done = 0;
+#if defined(__x86_64__)
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    if (hasAVX2) {
+        done = computeAVX2(params);
+    }
+#endif
+    computeScalar(params, done, params->size());
+}
+
+}  // namespace yj
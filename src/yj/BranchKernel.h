@@ -0,0 +1,51 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace yj {
+
+/**
+ * @brief BranchParams holds the parameters of a batch of branches as contiguous arrays, so
+ *  that the derived parameters are computed by one vectorized pass instead of per edge.
+ */
+struct BranchParams {
+    // Inputs: the impedance r + jx, and the rating, which is sqrt(3)*volt*Ih/1000 for lines
+    // and S for transformers, the gatherer leaves Ih or S zero for the other kind
+    std::vector<double> r;
+    std::vector<double> x;
+    std::vector<double> volt;
+    std::vector<double> ih;
+    std::vector<double> s;
+    // The topoids of both ends
+    std::vector<int64_t> from;
+    std::vector<int64_t> to;
+
+    // Outputs: the admittance g - jb, the DC susceptance, the limits in p.u. and whether the
+    // branch goes from the smaller topoid to the larger one, -1, or the other way, 1
+    std::vector<double> g;
+    std::vector<double> b;
+    std::vector<double> bij;
+    std::vector<double> lineQ1;
+    std::vector<double> lineQ2;
+    std::vector<double> lineQ3;
+    std::vector<int32_t> reverse;
+
+    size_t size() const {
+        return r.size();
+    }
+
+    void resize(size_t n);
+};
+
+/**
+ * @brief Compute the outputs of all the branches from the inputs. It runs the AVX2 kernel if
+ *  the CPU supports it, the rest of the batch and other CPUs run the scalar one. Both
+ *  evaluate the same expressions in the same order without FMA.
+ */
+void computeBranchParams(BranchParams *params);
+
+}  // namespace yj
@@ -0,0 +1,147 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#include "yj/BusBranchModel.h"
+
+#include <cstdlib>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+#include "nebula/common/datatype/List.h"
+#include "nebula/common/datatype/Value.h"
+#include "nebula/common/graph/MemGraph.h"
+
+using nebula::EdgeID;
+using nebula::NodeID;
+using nebula::Value;
+using nebula::computing::VertexIndex;
+
+namespace yj {
+
+namespace {
+
+/**
+ * @brief The numeric property as double, the properties of topo_connect are written as
+ *  either int or double depending on the kind of the branch.
+ */
+double numeric(const Value &v, double defaultValue = 0.0) {
+    if (v.isInteger()) {
+        return static_cast<double>(v.getInteger());
+    }
+    if (v.isFloat() || v.isDouble()) {
+        return v.getFloatingVal();
+    }
+    return defaultValue;
+}
+
+int64_t firstKey(const Value &v) {
+    if (!v.isList() || v.getList().size() == 0u) {
+        return 0;
+    }
+    const auto &key = v.getList().values().front();
+    return key.isInteger() ? key.getInteger() : 0;
+}
+
+}  // namespace
+
+BusBranchModel BusBranchAlgorithm::loadModel() const {
+    const auto *graph = this->graph();
+    auto *engine = ctx_->engine();
+
+    auto vids = graph->nodeIDs();
+    auto isBus = [this](NodeID vid) { return hasNodeLabel(vid, topoNDLabel); };
+    auto busVids = engine->runOnCurrentThread(engine->parallelFilter(vids, isBus));
+
+    BusBranchModel model;
+    model.buses = std::make_shared<VertexIndex>(std::move(busVids));
+    const auto &buses = *model.buses;
+
+    struct Scan {
+        int64_t topoID{0};
+        double injection{0.0};
+        std::vector<Branch> branches;
+    };
+    // The key_list of the forward edge of the transformer from src to dst named `name`, whose
+    // turns ratio is positive
+    auto forwardKey = [this, graph](NodeID src, NodeID dst, const Value &name) -> int64_t {
+        for (auto [b, e] = graph->outEdges(src); b != e; ++b) {
+            if (b.getDstID() != dst || !hasEdgeLabel(*b, topoConnectLabel)) continue;
+            EdgeID eid = *b;
+            if (numeric(graph->getProperty(eid, "transformer_final_turns_ratio")) > 0 &&
+                graph->getProperty(eid, "name") == name) {
+                return firstKey(graph->getProperty(eid, "key_list"));
+            }
+        }
+        return 0;
+    };
+    auto scan = [this, graph, &buses, &forwardKey](uint32_t from) {
+        Scan res;
+        auto vid = buses.vid(from);
+        auto topoID = graph->getProperty(vid, "topoid");
+        res.topoID = topoID.isInteger() ? topoID.getInteger() : 0;
+        // The branches read from the backward edge of a transformer, with the source and name
+        // of the edge
+        std::vector<std::tuple<size_t, NodeID, Value>> backward;
+        for (auto [b, e] = graph->outEdges(vid); b != e; ++b) {
+            if (!hasEdgeLabel(*b, topoConnectLabel)) continue;
+            auto to = buses.indexOf(b.getDstID());
+            if (to == VertexIndex::kInvalidIndex) continue;
+
+            EdgeID eid = *b;
+            res.injection += numeric(graph->getProperty(eid, "M_P_TLPF"));
+            if (numeric(graph->getProperty(eid, "reverse")) <= 0) continue;
+
+            Branch branch;
+            branch.from = from;
+            branch.to = to;
+            branch.g = numeric(graph->getProperty(eid, "G"));
+            branch.b = numeric(graph->getProperty(eid, "B"));
+            branch.hB = numeric(graph->getProperty(eid, "hB"));
+            branch.bij = numeric(graph->getProperty(eid, "BIJ"));
+            // The backward edge of a transformer carries the negated turns ratio
+            branch.tap = numeric(graph->getProperty(eid, "transformer_final_turns_ratio"), 1.0);
+            // The key is the id of the device. The backward edge of an AC line carries -id and
+            // the one of a two-port transformer the id of the other winding, so the key of a
+            // transformer is taken from its forward edge
+            branch.key = firstKey(graph->getProperty(eid, "key_list"));
+            if (branch.tap < 0) {
+                backward.emplace_back(
+                        res.branches.size(), b.getDstID(), graph->getProperty(eid, "name"));
+                std::swap(branch.from, branch.to);
+                branch.tap = -branch.tap;
+            }
+            if (branch.tap == 0) {
+                branch.tap = 1.0;
+            }
+            branch.limits[0] = numeric(graph->getProperty(eid, "line_Q1"));
+            branch.limits[1] = numeric(graph->getProperty(eid, "line_Q2"));
+            branch.limits[2] = numeric(graph->getProperty(eid, "line_Q3"));
+            res.branches.emplace_back(branch);
+        }
+        // Out of the loop, which holds the read lock of the edges of vid
+        for (const auto &[i, src, name] : backward) {
+            auto key = forwardKey(src, vid, name);
+            if (key != 0) {
+                res.branches[i].key = key;
+            }
+        }
+        for (auto &branch : res.branches) {
+            branch.key = std::abs(branch.key);
+        }
+        return res;
+    };
+    std::vector<uint32_t> indices(buses.size());
+    std::iota(indices.begin(), indices.end(), 0u);
+    auto scans = engine->runOnCurrentThread(engine->parallelFor(indices, scan));
+
+    model.topoIDs.reserve(scans.size());
+    model.injections.reserve(scans.size());
+    for (auto &res : scans) {
+        model.topoIDs.push_back(res.topoID);
+        model.injections.push_back(res.injection);
+        model.branches.insert(model.branches.end(), res.branches.begin(), res.branches.end());
+    }
+    return model;
+}
+
+}  // namespace yj
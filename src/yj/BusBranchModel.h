@@ -0,0 +1,80 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "nebula/common/datatype/ResultTable.h"
+#include "nebula/common/utils/Types.h"
+#include "nebula/computing/ComputingAlgorithm.h"
+#include "nebula/computing/ComputingContext.h"
+#include "nebula/computing/LabelMask.h"
+#include "nebula/computing/VertexIndex.h"
+
+namespace yj {
+
+/**
+ * @brief A branch of the bus-branch model, i.e. a pair of topo_connect edges. It's oriented
+ *  so that the off-nominal tap of a transformer is at the `from` bus.
+ */
+struct Branch {
+    uint32_t from;
+    uint32_t to;
+    // The series admittance is g - jb, and the line charging is j*hB at each end
+    double g;
+    double b;
+    double hB;
+    // The susceptance used by the DC power flow, 1/X
+    double bij;
+    double tap;
+    // The normal, emergency and load shedding flow limits, in p.u.
+    double limits[3];
+    // The id of the device, i.e. the AC line or the winding of the transformer on the tap side
+    int64_t key;
+};
+
+/**
+ * @brief BusBranchModel is the bus-branch model network_topo leaves in the graph: the TopoNDs
+ *  are the buses and the topo_connect edges are the branches.
+ */
+struct BusBranchModel {
+    // The dense index of the TopoNDs
+    std::shared_ptr<const nebula::computing::VertexIndex> buses;
+    // The topoid of each bus
+    std::vector<int64_t> topoIDs;
+    // The measured active power injected at each bus, i.e. the sum of the M_P_TLPF of the
+    // topo_connect edges leaving it, in p.u.
+    std::vector<double> injections;
+    std::vector<Branch> branches;
+
+    size_t numBuses() const {
+        return topoIDs.size();
+    }
+};
+
+struct BusBranchState {
+    void getResult(nebula::Row&) const {}
+};
+
+/**
+ * @brief BusBranchAlgorithm is the base of the algorithms on the bus-branch model.
+ */
+class BusBranchAlgorithm : public nebula::computing::ComputingAlgorithm<BusBranchState> {
+public:
+    using Super = nebula::computing::ComputingAlgorithm<BusBranchState>;
+
+    explicit BusBranchAlgorithm(nebula::computing::ComputingContext* ctx) : Super(ctx) {}
+
+protected:
+    /**
+     * @brief Load the bus-branch model from the graph in parallel. Of the two topo_connect
+     *  edges of a branch, only the one with a positive `reverse` is taken.
+     */
+    BusBranchModel loadModel() const;
+
+    const nebula::computing::LabelMask topoNDLabel = labelMask({"TopoND"});
+    const nebula::computing::LabelMask topoConnectLabel = labelMask({"topo_connect"});
+};
+
+}  // namespace yj
@@ -0,0 +1,329 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+
+#include "nebula/common/datatype/List.h"
+#include "nebula/common/graph/MemGraph.h"
+#include "nebula/common/table/RefCatalog.h"
+#include "nebula/common/valuetype/ValueType.h"
+#include "nebula/plugins/ProcedurePlugin.h"
+#include "yj/BusBranchModel.h"
+#include "yj/DCPowerFlow.h"
+
+using nebula::ExecutionOutcome;
+using nebula::NullValue;
+using nebula::ResultTable;
+using nebula::Row;
+using nebula::Status;
+using nebula::Value;
+using nebula::computing::ComputingContext;
+using nebula::plugin::Field;
+using nebula::plugin::Parameter;
+using nebula::plugin::ProcContextPtr;
+using nebula::plugin::Procedure;
+
+namespace yj {
+
+namespace {
+
+/**
+ * @brief Solve the small dense system m x = rhs in place by Gaussian elimination with partial
+ *  pivoting, m is row major.
+ * @return false if m is singular.
+ */
+bool denseSolve(std::vector<double> &m, std::vector<double> &rhs) {
+    auto r = rhs.size();
+    for (size_t k = 0; k < r; ++k) {
+        auto pivot = k;
+        for (size_t i = k + 1; i < r; ++i) {
+            if (std::fabs(m[i * r + k]) > std::fabs(m[pivot * r + k])) {
+                pivot = i;
+            }
+        }
+        if (std::fabs(m[pivot * r + k]) < 1e-9) {
+            return false;
+        }
+        if (pivot != k) {
+            for (size_t j = 0; j < r; ++j) {
+                std::swap(m[k * r + j], m[pivot * r + j]);
+            }
+            std::swap(rhs[k], rhs[pivot]);
+        }
+        for (size_t i = k + 1; i < r; ++i) {
+            auto f = m[i * r + k] / m[k * r + k];
+            for (size_t j = k; j < r; ++j) {
+                m[i * r + j] -= f * m[k * r + j];
+            }
+            rhs[i] -= f * rhs[k];
+        }
+    }
+    for (size_t k = r; k-- > 0;) {
+        for (size_t j = k + 1; j < r; ++j) {
+            rhs[k] -= m[k * r + j] * rhs[j];
+        }
+        rhs[k] /= m[k * r + k];
+    }
+    return true;
+}
+
+}  // namespace
+
+/**
+ * @brief ContingencyAlgorithm screens the outages of branches with the DC power flow. B' is
+ *  factorized once, and the angles after each outage are derived from the base case by a
+ *  Sherman-Morrison-Woodbury update of the rank of the branches taken out, so an outage
+ *  costs one triangular solve per branch instead of a factorization.
+ */
+class ContingencyAlgorithm final : public BusBranchAlgorithm {
+public:
+    // The outages to screen, empty for all of the branches
+    ContingencyAlgorithm(ComputingContext *ctx, std::vector<int64_t> outages)
+            : BusBranchAlgorithm(ctx), outages_(std::move(outages)) {}
+
+    std::string name() const override {
+        return "contingency";
+    }
+
+    void run() override {
+        auto *engine = ctx_->engine();
+        model_ = loadModel();
+        if (!pf_.factorize(model_, engine)) {
+            return;
+        }
+        theta_ = pf_.solve(model_.injections);
+
+        // All the branches sharing a key, e.g. the windings of a transformer, go out together
+        std::map<int64_t, std::vector<uint32_t>> byKey;
+        for (uint32_t i = 0; i < model_.branches.size(); ++i) {
+            if (DCPowerFlow::inService(model_.branches[i])) {
+                byKey[model_.branches[i].key].push_back(i);
+            }
+        }
+        std::vector<std::vector<uint32_t>> contingencies;
+        if (outages_.empty()) {
+            for (auto &kv : byKey) {
+                outages_.push_back(kv.first);
+                contingencies.emplace_back(std::move(kv.second));
+            }
+        } else {
+            std::vector<int64_t> found;
+            for (auto key : outages_) {
+                auto iter = byKey.find(key);
+                if (iter != byKey.end()) {
+                    found.push_back(key);
+                    contingencies.push_back(iter->second);
+                }
+            }
+            outages_.swap(found);
+        }
+
+        std::vector<uint32_t> indices(contingencies.size());
+        std::iota(indices.begin(), indices.end(), 0u);
+        auto screen = [this, &contingencies](uint32_t c) {
+            return screenOutage(c, contingencies[c]);
+        };
+        auto results = engine->runOnCurrentThread(engine->parallelFor(indices, screen));
+        for (auto &res : results) {
+            violations_.insert(violations_.end(), res.begin(), res.end());
+        }
+    }
+
+    /**
+     * @brief One row per violation: the outage, the overloaded branch and its topoids, its
+     *  flow after the outage, the limit and its level, 1 for line_Q1 up to 3 for line_Q3.
+     *  The flow and the limit are both in p.u. of DCPowerFlow::kBaseMVA, like the flows of
+     *  dc_power_flow. An outage which splits an island has a single row with level 0 and
+     *  nulls.
+     */
+    void getResult(ResultTable *result) const {
+        for (const auto &v : violations_) {
+            Row row;
+            row.append(outages_[v.outage]);
+            if (v.level == 0) {
+                for (size_t i = 0; i < 5; ++i) {
+                    row.append(NullValue::kNullValue);
+                }
+            } else {
+                const auto &branch = model_.branches[v.branch];
+                row.append(branch.key);
+                row.append(model_.topoIDs[branch.from]);
+                row.append(model_.topoIDs[branch.to]);
+                row.append(v.flow);
+                row.append(branch.limits[v.level - 1]);
+            }
+            row.append(static_cast<int64_t>(v.level));
+            result->append(std::move(row));
+        }
+    }
+
+private:
+    struct Violation {
+        uint32_t outage;
+        uint32_t branch;
+        double flow;
+        int level;
+    };
+
+    std::vector<Violation> screenOutage(uint32_t c, const std::vector<uint32_t> &out) const {
+        const auto &branches = model_.branches;
+        auto r = out.size();
+
+        // X = B'^-1 U, where each column of U is e_from - e_to of a branch taken out. The rows
+        // and columns of the slack buses in B' are the identity, so B' only loses the rank one
+        // terms of the other buses, i.e. the slack entries of each column of U are zero.
+        auto entry = [this](uint32_t bus) { return pf_.isSlack(bus) ? 0.0 : 1.0; };
+        std::vector<std::vector<double>> x(r);
+        for (size_t j = 0; j < r; ++j) {
+            std::vector<double> a(model_.numBuses(), 0.0);
+            a[branches[out[j]].from] += entry(branches[out[j]].from);
+            a[branches[out[j]].to] -= entry(branches[out[j]].to);
+            x[j] = pf_.solve(std::move(a));
+        }
+        auto across = [&branches](uint32_t i, const std::vector<double> &v) {
+            return v[branches[i].from] - v[branches[i].to];
+        };
+        // U' v of the column of U of the branch i
+        auto update = [&branches, &entry](uint32_t i, const std::vector<double> &v) {
+            const auto &branch = branches[i];
+            return entry(branch.from) * v[branch.from] - entry(branch.to) * v[branch.to];
+        };
+
+        // Solve (D^-1 - U' X) z = U' theta, then theta' = theta + X z
+        std::vector<double> m(r * r), z(r);
+        for (size_t i = 0; i < r; ++i) {
+            for (size_t j = 0; j < r; ++j) {
+                m[i * r + j] = -update(out[i], x[j]);
+            }
+            m[i * r + i] += 1.0 / branches[out[i]].bij;
+            z[i] = update(out[i], theta_);
+        }
+        if (!denseSolve(m, z)) {
+            return {Violation{c, 0u, 0.0, 0}};
+        }
+
+        std::vector<Violation> res;
+        for (uint32_t i = 0; i < branches.size(); ++i) {
+            const auto &branch = branches[i];
+            if (!DCPowerFlow::inService(branch) ||
+                std::find(out.begin(), out.end(), i) != out.end()) {
+                continue;
+            }
+            auto diff = across(i, theta_);
+            for (size_t j = 0; j < r; ++j) {
+                diff += across(i, x[j]) * z[j];
+            }
+            // In p.u., the unit of line_Q1..3
+            auto flow = branch.bij * diff;
+            int level = 0;
+            for (int l = 0; l < 3; ++l) {
+                if (branch.limits[l] > 0 && std::fabs(flow) > branch.limits[l]) {
+                    level = l + 1;
+                }
+            }
+            if (level > 0) {
+                res.push_back(Violation{c, i, flow, level});
+            }
+        }
+        return res;
+    }
+
+    std::vector<int64_t> outages_;
+    BusBranchModel model_;
+    DCPowerFlow pf_;
+    std::vector<double> theta_;
+    std::vector<Violation> violations_;
+};
+
+}  // namespace yj
+
+static constexpr const char *kContingencyColumnNames[] = {
+        "outageKey",
+        "key",
+        "itopoID",
+        "jtopoID",
+        // The flow after the outage and the violated limit, in p.u.
+        "P",
+        "limit",
+        "level",
+};
+
+static folly::Future<ExecutionOutcome> contingencyProcedure(ProcContextPtr pctx,
+                                                            std::vector<Value> args) {
+    ExecutionOutcome outcome;
+    outcome.status = Status::OK();
+
+    if (!pctx->rctx()) {
+        return outcome;
+    }
+
+    if (args.size() < 2u || !args[0].isString()) {
+        return outcome;
+    }
+
+    std::vector<int64_t> outages;
+    if (args[1].isList()) {
+        for (const auto &v : args[1].getList().values()) {
+            if (v.isInt64()) {
+                outages.push_back(v.getInt64());
+            }
+        }
+        if (outages.empty()) {
+            return outcome;
+        }
+    } else if (!args[1].isString() || args[1].getString() != "all") {
+        return outcome;
+    }
+
+    auto engine = pctx->computingEngine();
+
+    const auto &ref = args[0].getRef();
+    auto memGraph = pctx->refCatalog()->getGraph(ref.entryID());
+
+    auto ctx = std::make_unique<ComputingContext>(engine, memGraph.get(), pctx->rctx());
+    auto algo = std::make_unique<yj::ContingencyAlgorithm>(ctx.get(), std::move(outages));
+    algo->run();
+
+    ResultTable table;
+    std::vector<std::string> colNames{std::begin(kContingencyColumnNames),
+                                      std::end(kContingencyColumnNames)};
+    table.setColumnNames(std::move(colNames));
+
+    algo->getResult(&table);
+
+    outcome.result.emplace(std::move(table));
+    return outcome;
+}
+
+Procedure declareContingencyProcedure() {
+    Procedure proc;
+    proc.name = "contingency";
+    proc.comment =
+            "N-1 contingency screening of branch outages by the DC power flow, the flows and "
+            "limits are in p.u.";
+    proc.func = &contingencyProcedure;
+    proc.params = {
+            Parameter{
+                    std::make_shared<nebula::StringValueType>(),
+                    "graphName",
+                    "graph name",
+            },
+            Parameter{
+                    std::make_shared<nebula::AnyValueType>(),
+                    "outages",
+                    "the key_list IDs of the branches to take out, or \"all\"",
+            },
+    };
+    proc.fields = {
+            Field{std::make_shared<nebula::Int64ValueType>(), "outageKey"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "key"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "itopoID"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "jtopoID"},
+            Field{std::make_shared<nebula::Float64ValueType>(), "P"},
+            Field{std::make_shared<nebula::Float64ValueType>(), "limit"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "level"},
+    };
+    return proc;
+}
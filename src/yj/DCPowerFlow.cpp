@@ -0,0 +1,77 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#include "yj/DCPowerFlow.h"
+
+#include <cmath>
+
+#include "nebula/computing/DisjointSet.h"
+#include "yj/SparseMatrix.h"
+
+using nebula::computing::DisjointSet;
+
+namespace yj {
+
+bool DCPowerFlow::inService(const Branch& branch) {
+    return std::isfinite(branch.bij) && branch.bij != 0.0 && branch.from != branch.to;
+}
+
+bool DCPowerFlow::factorize(const BusBranchModel& model,
+                            nebula::computing::ComputingEngine* engine) {
+    auto n = model.numBuses();
+
+    // Pick the slack bus of each island
+    DisjointSet islands(n);
+    for (const auto& branch : model.branches) {
+        if (inService(branch)) {
+            islands.unite(branch.from, branch.to);
+        }
+    }
+    std::vector<uint32_t> slackOf(n);
+    for (uint32_t bus = 0; bus < n; ++bus) {
+        auto root = islands.find(bus);
+        if (root == bus || model.injections[bus] > model.injections[slackOf[root]]) {
+            slackOf[root] = bus;
+        }
+    }
+    slack_.assign(n, false);
+    for (uint32_t bus = 0; bus < n; ++bus) {
+        slack_[slackOf[islands.find(bus)]] = true;
+    }
+
+    // The rows and columns of the slack buses are replaced by the identity
+    std::vector<Triplet<double>> triplets;
+    triplets.reserve(model.branches.size() * 4 + n);
+    for (uint32_t bus = 0; bus < n; ++bus) {
+        if (slack_[bus]) {
+            triplets.push_back({bus, bus, 1.0});
+        }
+    }
+    for (const auto& branch : model.branches) {
+        if (!inService(branch)) continue;
+        auto f = branch.from, t = branch.to;
+        if (!slack_[f]) {
+            triplets.push_back({f, f, branch.bij});
+        }
+        if (!slack_[t]) {
+            triplets.push_back({t, t, branch.bij});
+        }
+        if (!slack_[f] && !slack_[t]) {
+            triplets.push_back({f, t, -branch.bij});
+            triplets.push_back({t, f, -branch.bij});
+        }
+    }
+    auto bp = CSRMatrix<double>::assemble(n, triplets, engine);
+    return factor_.factorize(bp);
+}
+
+std::vector<double> DCPowerFlow::solve(std::vector<double> injections) const {
+    for (size_t bus = 0; bus < injections.size(); ++bus) {
+        if (slack_[bus]) {
+            injections[bus] = 0.0;
+        }
+    }
+    factor_.solve(injections);
+    return injections;
+}
+
+}  // namespace yj
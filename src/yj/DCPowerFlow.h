@@ -0,0 +1,56 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <vector>
+
+#include "nebula/computing/ComputingEngine.h"
+#include "yj/BusBranchModel.h"
+#include "yj/SparseLDL.h"
+
+namespace yj {
+
+/**
+ * @brief DCPowerFlow solves the DC power flow B' theta = P of a bus-branch model. The bus with
+ *  the largest injection of each island is its slack bus, whose angle is fixed at zero.
+ */
+class DCPowerFlow final {
+public:
+    // The power base of the p.u. values, e.g. M_P_TLPF
+    static constexpr double kBaseMVA = 100.0;
+
+    /**
+     * @brief Build B' from the BIJ of the branches and factorize it.
+     * @return false if B' is singular.
+     */
+    bool factorize(const BusBranchModel& model, nebula::computing::ComputingEngine* engine);
+
+    /**
+     * @brief Solve the bus angles, in radians, of the given injections in p.u.
+     */
+    std::vector<double> solve(std::vector<double> injections) const;
+
+    bool isSlack(uint32_t bus) const {
+        return slack_[bus];
+    }
+
+    const SparseLDL& factor() const {
+        return factor_;
+    }
+
+    /**
+     * @brief Whether the branch takes part in the DC power flow, i.e. it has a finite nonzero
+     *  susceptance.
+     */
+    static bool inService(const Branch& branch);
+
+    static double flow(const Branch& branch, const std::vector<double>& theta) {
+        return branch.bij * (theta[branch.from] - theta[branch.to]);
+    }
+
+private:
+    std::vector<bool> slack_;
+    SparseLDL factor_;
+};
+
+}  // namespace yj
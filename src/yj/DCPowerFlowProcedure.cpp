@@ -0,0 +1,145 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#include <numeric>
+
+#include "nebula/common/graph/MemGraph.h"
+#include "nebula/common/table/RefCatalog.h"
+#include "nebula/common/valuetype/ValueType.h"
+#include "nebula/plugins/ProcedurePlugin.h"
+#include "yj/BusBranchModel.h"
+#include "yj/DCPowerFlow.h"
+
+using nebula::ExecutionOutcome;
+using nebula::ResultTable;
+using nebula::Row;
+using nebula::Status;
+using nebula::Value;
+using nebula::computing::ComputingContext;
+using nebula::plugin::Field;
+using nebula::plugin::Parameter;
+using nebula::plugin::ProcContextPtr;
+using nebula::plugin::Procedure;
+
+namespace yj {
+
+/**
+ * @brief DCPowerFlowAlgorithm solves the DC power flow of the bus-branch model with the
+ *  measured injections, and computes the flow of each branch from the angles.
+ */
+class DCPowerFlowAlgorithm final : public BusBranchAlgorithm {
+public:
+    explicit DCPowerFlowAlgorithm(ComputingContext *ctx) : BusBranchAlgorithm(ctx) {}
+
+    std::string name() const override {
+        return "dc_powerflow";
+    }
+
+    void run() override {
+        auto *engine = ctx_->engine();
+        model_ = loadModel();
+        DCPowerFlow pf;
+        if (!pf.factorize(model_, engine)) {
+            // Leave the result empty rather than returning the angles of a singular system
+            return;
+        }
+        theta_ = pf.solve(model_.injections);
+
+        std::vector<uint32_t> indices(model_.branches.size());
+        std::iota(indices.begin(), indices.end(), 0u);
+        auto flow = [this](uint32_t i) {
+            const auto &branch = model_.branches[i];
+            return DCPowerFlow::inService(branch) ? DCPowerFlow::flow(branch, theta_) : 0.0;
+        };
+        flows_ = engine->runOnCurrentThread(engine->parallelFor(indices, flow));
+    }
+
+    /**
+     * @brief One row per branch: its key, the topoid and the angle of both ends, and the
+     *  active power flowing from `from` to `to` in p.u.
+     */
+    void getResult(ResultTable *result) const {
+        for (size_t i = 0; i < flows_.size(); ++i) {
+            const auto &branch = model_.branches[i];
+            Row row;
+            row.append(branch.key);
+            row.append(model_.topoIDs[branch.from]);
+            row.append(model_.topoIDs[branch.to]);
+            row.append(theta_[branch.from]);
+            row.append(theta_[branch.to]);
+            row.append(flows_[i]);
+            result->append(std::move(row));
+        }
+    }
+
+private:
+    BusBranchModel model_;
+    std::vector<double> theta_;
+    std::vector<double> flows_;
+};
+
+}  // namespace yj
+
+static constexpr const char *kDCPowerFlowColumnNames[] = {
+        "key",
+        "itopoID",
+        "jtopoID",
+        "thetaI",
+        "thetaJ",
+        "P",
+};
+
+static folly::Future<ExecutionOutcome> dcPowerFlowProcedure(ProcContextPtr pctx,
+                                                            std::vector<Value> args) {
+    ExecutionOutcome outcome;
+    outcome.status = Status::OK();
+
+    if (!pctx->rctx()) {
+        return outcome;
+    }
+
+    if (args.size() < 1u || !args[0].isString()) {
+        return outcome;
+    }
+
+    auto engine = pctx->computingEngine();
+
+    const auto &ref = args[0].getRef();
+    auto memGraph = pctx->refCatalog()->getGraph(ref.entryID());
+
+    auto ctx = std::make_unique<ComputingContext>(engine, memGraph.get(), pctx->rctx());
+    auto algo = std::make_unique<yj::DCPowerFlowAlgorithm>(ctx.get());
+    algo->run();
+
+    ResultTable table;
+    std::vector<std::string> colNames{std::begin(kDCPowerFlowColumnNames),
+                                      std::end(kDCPowerFlowColumnNames)};
+    table.setColumnNames(std::move(colNames));
+
+    algo->getResult(&table);
+
+    outcome.result.emplace(std::move(table));
+    return outcome;
+}
+
+Procedure declareDCPowerFlowProcedure() {
+    Procedure proc;
+    proc.name = "dc_powerflow";
+    proc.comment = "DC power flow over the bus-branch model built by network_topo";
+    proc.func = &dcPowerFlowProcedure;
+    proc.params = {
+            Parameter{
+                    std::make_shared<nebula::StringValueType>(),
+                    "graphName",
+                    "graph name",
+            },
+    };
+    proc.fields = {
+            Field{std::make_shared<nebula::Int64ValueType>(), "key"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "itopoID"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "jtopoID"},
+            Field{std::make_shared<nebula::Float64ValueType>(), "thetaI"},
+            Field{std::make_shared<nebula::Float64ValueType>(), "thetaJ"},
+            Field{std::make_shared<nebula::Float64ValueType>(), "P"},
+    };
+    return proc;
+}
@@ -1,22 +1,42 @@
 // Copyright (c) 2023 vesoft inc. All rights reserved.
 
-#include <folly/RWSpinLock.h>
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <optional>
+
+#include <folly/Synchronized.h>
 #include <folly/concurrency/ConcurrentHashMap.h>
+#include <folly/hash/Hash.h>
 
 #include "nebula/common/datatype/Edge.h"
 #include "nebula/common/datatype/List.h"
+#include "nebula/common/datatype/Record.h"
 #include "nebula/common/graph/MemGraph.h"
+#include "nebula/common/memory/MemoryTracker.h"
 #include "nebula/common/module/Module.h"
 #include "nebula/common/module/ModuleManager.h"
 #include "nebula/common/table/RefCatalog.h"
 #include "nebula/common/utils/Types.h"
 #include "nebula/common/valuetype/ValueType.h"
+#include "nebula/computing/AtomicBitSet.h"
 #include "nebula/computing/ComputingAlgorithm.h"
 #include "nebula/computing/ComputingContext.h"
+#include "nebula/computing/ConcurrentCollector.h"
+#include "nebula/computing/DisjointSet.h"
+#include "nebula/computing/EmitOnce.h"
+#include "nebula/computing/LabelMask.h"
+#include "nebula/computing/SparseSideTable.h"
 #include "nebula/computing/VertexSubset.h"
 #include "nebula/plugins/ProcedurePlugin.h"
+#include "yj/BranchKernel.h"
+#include "yj/TopoConnectSchema.h"
 
 using nebula::Edge;
+using nebula::EdgeID;
 using nebula::ExecutionOutcome;
 using nebula::List;
 using nebula::MemGraph;
@@ -29,7 +49,12 @@ using nebula::Status;
 using nebula::String;
 using nebula::Value;
 using nebula::ValueTypeKind;
+using nebula::properties_type;
 using nebula::computing::ComputingContext;
+using nebula::computing::ConcurrentCollector;
+using nebula::computing::LabelMask;
+using nebula::computing::LabelPath;
+using nebula::computing::MutationLog;
 using nebula::computing::VertexSubset;
 using nebula::module::ModuleManager;
 using nebula::plugin::Field;
@@ -44,16 +69,12 @@ struct NetworkTopoState {
     int32_t breakerPoint{0};
     int32_t disPoint{0};
     int64_t maxTopoID{-1};
-    int64_t maxBDID{-1};
     int sumIID{0};
     int sumJID{0};
     double sumQimeas{0.0};
     double sumBusQMeas{0.0};
     double sumAclineCount{0.0};
     int64_t sumLineNo{0};
-    std::set<int64_t> setTopoID1;
-    std::list<std::string> listTpndName;
-    std::list<double> listTpndQMeas;
 
     // Need to be updated fields
     std::optional<int64_t> topoID{-1};
@@ -61,6 +82,14 @@ struct NetworkTopoState {
     std::optional<int64_t> itopoID;
     std::optional<int64_t> jtopoID;
 
+    /**
+     * @brief Whether the state has been written by the algorithm.
+     */
+    bool touched() const {
+        return maxTopoID != -1 || sumIID != 0 || sumJID != 0 || topoID.value_or(-1) != -1 ||
+               point.value_or(-1) != -1;
+    }
+
     void getResult(Row &row) const {
         row.append(topoID.has_value() ? Value(topoID.value()) : NullValue::kNullValue);
         row.append(point.has_value() ? Value(point.value()) : NullValue::kNullValue);
@@ -69,6 +98,40 @@ struct NetworkTopoState {
     }
 };
 
+/**
+ * @brief The payload of the AC line dots and their TopoNDs collected for Frm_To_Cp, which
+ *  only a few vertices have, so it's kept out of NetworkTopoState.
+ */
+struct TopoPayload {
+    std::set<int64_t> setTopoID1;
+    std::list<std::string> listTpndName;
+    std::list<double> listTpndQMeas;
+};
+
+/**
+ * @brief The topoID assignment left by a run of the network topology algorithm, a later delta
+ *  run starts from it instead of rebuilding the whole topology.
+ */
+struct NetworkTopoSnapshot {
+    // The topoID seeded on each merged CN by its equipments before merging the buses
+    std::unordered_map<NodeID, int64_t> seeds;
+    // The topoID seeded by each equipment, i.e. its `nd`, which the TopoND is elected from
+    std::unordered_map<NodeID, int64_t> equipmentSeeds;
+    // The merged CNs of each bus keyed by the topoID of the bus
+    std::unordered_map<int64_t, std::vector<NodeID>> buses;
+    // The states of all vertices touched by the run
+    std::unordered_map<NodeID, NetworkTopoState> states;
+};
+
+/**
+ * @brief The status a scenario puts a breaker/disconnector in, `point` is 1 for closed and
+ *  0 for open, the same as the `point` property of the switch.
+ */
+struct SwitchTarget {
+    NodeID sw;
+    int64_t point;
+};
+
 class NetworkTopoAlgorithm : public nebula::computing::ComputingAlgorithm<NetworkTopoState> {
 public:
     using Super = nebula::computing::ComputingAlgorithm<NetworkTopoState>;
@@ -85,97 +148,27 @@ public:
 
     void run() override {
         auto *graph = this->graph();
+        profiler().start();
+        buildCSR();
+        profiler().lap("buildCSR", vertexIndex().size());
 
         VertexSubset all(ctx_, graph->nodeIDs());
 
         VertexSubset A11 = verticesByAllLabels(all, {"Substation"});
+        profiler().lap("A11", all.size(), A11.size());
         VertexSubset tNeutralPoint = verticesByAllLabels(all, {"neutral_point"});
+        profiler().lap("tNeutralPoint", all.size(), tNeutralPoint.size());
         VertexSubset discreteSet = verticesByAllLabels(all, {"discrete"});
+        profiler().lap("discreteSet", all.size(), discreteSet.size());
 
-        VertexSubset disSetByFlag = discreteSet.filter([graph](NodeID s) -> bool {
+        VertexSubset disSetByFlag = discreteSet.filter([this](NodeID s) -> bool {
             auto cond = [](const auto &v) -> bool { return v.getInt64() == 1; };
-            return graph->hasProperty(s, "updateFlag", cond);
-        });
-
-        VertexSubset breakerSet = disSetByFlag.map([this, graph](NodeID s) {
-            auto flagM = graph->getProperty(s, "flagM");
-            auto statusM = graph->getProperty(s, "statusM");
-            auto status = graph->getProperty(s, "status");
-            int32_t delta = flagM.getInt64() == 1 ? statusM.getInt64() : status.getInt64();
-
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                for (auto &l : getEdgeLabelSet(e.getEdgeID())) {
-                    if (l == "discrete_breaker") {
-                        return true;
-                    }
-                }
-                return false;
-            });
-            for (auto t : tgts) {
-                write<int32_t>(&state(t).breakerPoint, delta);
-            }
-            return tgts;
-        });
-
-        breakerSet.forEach([this, graph](NodeID t) {
-            auto name = graph->getProperty(t, "name").getString();
-            int64_t point = -1;
-            static auto names = std::unordered_set<String>{
-                    "四川.桃坪厂/13.8kV.2开关",
-                    "四川.桃坪厂/13.8kV.3开关",
-                    "阿坝.岷江电化站/110kV.151开关",
-                    "阿坝.岷江电化站/10kV.1#主变低压侧901开关",
-            };
-            if (names.count(name)) {
-                point = 1;
-            } else if (name == "广元.太公电铁站/110kV.102开关") {
-                point = 0;
-            } else {
-                point = state(t).breakerPoint;
-            }
-            // TODO(yee): in-place update in the memory graph
-            state(t).point = point;
-        });
-
-        VertexSubset disSet = disSetByFlag.map([this, graph](NodeID s) {
-            auto flagM = graph->getProperty(s, "flagM");
-            auto statusM = graph->getProperty(s, "statusM");
-            auto status = graph->getProperty(s, "status");
-            int32_t delta = flagM.getInt64() == 1 ? statusM.getInt64() : status.getInt64();
-
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                for (auto &l : getEdgeLabelSet(e.getEdgeID())) {
-                    if (l == "discrete_dis") {
-                        return true;
-                    }
-                }
-                return false;
-            });
-            for (auto t : tgts) {
-                write<int32_t>(&state(t).disPoint, delta);
-            }
-            return tgts;
+            return hasProperty(s, "updateFlag", cond);
         });
+        profiler().lap("disSetByFlag", discreteSet.size(), disSetByFlag.size());
 
-        disSet.forEach([this, graph](NodeID s) {
-            auto name = graph->getProperty(s, "name").getString();
-            int64_t point = -1;
-            static auto names = std::unordered_set<String>{
-                    "四川.瀑布沟厂/500kV.50126刀闸",
-                    "四川.瀑布沟厂/500kV.50526刀闸",
-                    "四川.红房子厂/220kV.2516刀闸",
-                    "四川.红房子厂/220kV.2516刀闸",
-            };
-            if (names.count(name)) {
-                point = 1;
-            } else if (name == "广元.太公电铁站/110kV.1021刀闸") {
-                point = 0;
-            } else {
-                point = state(s).disPoint;
-            }
-            // TODO(yee): in-place update in the memory graph
-            state(s).point = point;
-        });
+        resolveSwitchPoints(disSetByFlag);
+        profiler().lap("resolveSwitchPoints", disSetByFlag.size());
 
         std::set<std::string> connectedSubLabels = {
                 "connected_Sub_Bus",
@@ -186,57 +179,35 @@ public:
                 "connected_Sub_Trans_three",
                 "connected_Sub_Compensator_P",
         };
-        VertexSubset selectSub = A11.map([this, graph, &connectedSubLabels](NodeID s) {
+        auto connectedSub = labelMask(connectedSubLabels);
+        VertexSubset selectSub = A11.map([this, &connectedSub](NodeID s) {
             std::unordered_set<NodeID> tgts;
-            auto f = [this, &connectedSubLabels](const Edge &e) -> bool {
-                auto labels = getEdgeLabelSet(e.getEdgeID());
-                for (auto &l : connectedSubLabels) {
-                    for (auto &ll : labels) {
-                        if (l == ll) {
-                            return true;
-                        }
-                    }
-                }
-                return false;
-            };
-            for (auto t : graph->outNeighborIDs(s, f)) {
-                auto off = graph->getProperty(t, "off");
+            for (auto t : neighborIDs(s, connectedSub, EdgeDirection::kOutEdge)) {
+                auto off = getProperty(t, "off");
                 if (off.isInt64() && off.getInt64() == 0) {
                     tgts.emplace(t);
                 }
             }
             return std::vector<NodeID>{tgts.begin(), tgts.end()};
         });
-        VertexSubset cnOpenSub = selectSub.map([this, graph](NodeID s) {
-            return graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                for (auto &l : getEdgeLabelSet(e.getEdgeID())) {
-                    if (l == "cn_subid") {
-                        return true;
-                    }
-                }
-                return false;
-            });
+        profiler().lap("selectSub", A11.size(), selectSub.size());
+        VertexSubset cnOpenSub = selectSub.map([this](NodeID s) {
+            return neighborIDs(s, cnSubidLabel);
         });
-        VertexSubset miscellaneous = selectSub.map([this, graph, connectedSubLabels](NodeID s) {
+        profiler().lap("cnOpenSub", selectSub.size(), cnOpenSub.size());
+        auto connectedSubOrS = connectedSub;
+        connectedSubOrS |= labelMask({"connected_Sub_Compensator_S"});
+        VertexSubset miscellaneous = selectSub.map([this, &connectedSubOrS](NodeID s) {
             std::unordered_set<NodeID> tgts;
-            std::set<std::string> labels(connectedSubLabels.begin(), connectedSubLabels.end());
-            labels.emplace("connected_Sub_Compensator_S");
-            auto f = [this, &labels](const Edge &e) -> bool {
-                for (auto &l : getEdgeLabelSet(e.getEdgeID())) {
-                    if (labels.count(l)) {
-                        return true;
-                    }
-                }
-                return false;
-            };
-            for (auto t : graph->outNeighborIDs(s, f)) {
-                auto off = graph->getProperty(t, "off");
+            for (auto t : neighborIDs(s, connectedSubOrS, EdgeDirection::kOutEdge)) {
+                auto off = getProperty(t, "off");
                 if (off.isInt64() && off.getInt64() == 0) {
                     tgts.emplace(t);
                 }
             }
             return std::vector<NodeID>{tgts.begin(), tgts.end()};
         });
+        profiler().lap("miscellaneous", selectSub.size(), miscellaneous.size());
         std::set<std::string> cnLabels = {
                 "connected_Bus_CN",
                 "connected_Load_CN",
@@ -247,102 +218,437 @@ public:
                 "connected_Compensator_P_CN",
                 "connected_Compensator_S_CN",
         };
-        VertexSubset cnTotal = miscellaneous.map([this, graph, &cnLabels](NodeID s) {
-            auto nd = graph->getProperty(s, "nd").getInt64();
-            auto tgts = graph->neighborIDs(s, [this, &cnLabels](const Edge &e) -> bool {
-                for (auto &l : getEdgeLabelSet(e.getEdgeID())) {
-                    if (cnLabels.count(l)) {
-                        return true;
-                    }
-                }
-                return false;
-            });
+        auto cnMask = labelMask(cnLabels);
+        VertexSubset cnTotal = miscellaneous.map([this, &cnMask](NodeID s) {
+            auto nd = getProperty(s, "nd").getInt64();
+            auto tgts = neighborIDs(s, cnMask);
             for (auto t : tgts) {
                 writeMax<int64_t>(&state(t).maxTopoID, nd);
                 writeMax<int64_t>(&state(s).maxTopoID, nd);
             }
             return tgts;
         });
+        profiler().lap("cnTotal", miscellaneous.size(), cnTotal.size());
+        for (auto vid : miscellaneous.vids()) {
+            equipmentSeeds.emplace(vid, state(vid).maxTopoID);
+        }
 
-        std::atomic_int sumCounter = 0;
-        int sumOldCounter = 1;
-        VertexSubset cnSet = cnOpenSub;
-        std::set<std::string> bdLabels = {"connected_Breaker_CN", "connected_Disconnector_CN"};
-        while (sumOldCounter != sumCounter) {
-            sumOldCounter = sumCounter;
-            VertexSubset bdSet = cnSet.map([this, graph, &bdLabels](NodeID s) {
-                auto tgts = graph->neighborIDs(s, [this, &bdLabels](const Edge &e) -> bool {
-                    for (auto &l : getEdgeLabelSet(e.getEdgeID())) {
-                        if (bdLabels.count(l)) {
-                            return true;
-                        }
-                    }
-                    return false;
-                });
-                for (auto t : tgts) {
-                    writeMax<int64_t>(&state(t).maxBDID, state(s).maxTopoID);
+        mergeBuses(cnOpenSub);
+        profiler().lap("mergeBuses", cnOpenSub.size());
+
+        auto topoNodes = buildTopoNodes(cnTotal);
+        profiler().lap("buildTopoNodes", cnTotal.size(), topoNodes.size());
+
+        VertexSubset totalTopoNodes = tNeutralPoint.filter([this](NodeID t) {
+            auto iOff = getProperty(t, "I_off").getInt64();
+            auto kOff = getProperty(t, "K_off").getInt64();
+            auto jOff = getProperty(t, "J_off").getInt64();
+            return iOff + kOff + jOff <= 1;
+        });
+        profiler().lap("totalTopoNodes", tNeutralPoint.size(), totalTopoNodes.size());
+        totalTopoNodes.forEach([this](NodeID t) {
+            auto midPoint = getProperty(t, "middle_point").getInt64();
+            emitNode("TopoND",
+                     {
+                             {"topoid", midPoint},
+                             {"TOPOID", midPoint},
+                             {"bus_name", getProperty(t, "name")},
+                             {"base_kV", 1},
+                             {"desired_volts", 1},
+                             {"up_V", 1.1},
+                             {"lo_V", 0.9},
+                             {"Ri_vP", 0},
+                             {"Ri_vQ", 0},
+                             {"start_pt", 0.0},
+                             {"nodeSI", 0.0},
+                             {"nodeCSeverity", 1},
+                             {"ZJP", 1},
+                             {"ZJQ", 0},
+                     });
+            emitEdge("topo_neutral", {midPoint}, {midPoint});
+        });
+        flushMutations();
+        profiler().lap("topoNeutral", totalTopoNodes.size());
+
+        VertexSubset checkNode3 = verticesByAllLabels(all, {"TopoND"});
+        profiler().lap("checkNode3", all.size(), checkNode3.size());
+
+        buildTopoEdges(cnTotal);
+
+        buildBranches(cnOpenSub);
+
+        // Frm_To_Cp walks the topo_* edges, so they must be in the graph by now
+        flushMutations();
+        profiler().lap("flushBranches", cnOpenSub.size());
+        if (capturingMutations()) {
+            // A dry run keeps the edges in memory, where Frm_To_Cp can't walk them, so its
+            // topo_connect edges have no from_CP/to_CP or CP lists, unlike a real run
+            return;
+        }
+        setFrmToCp(all);
+    }  // end of run
+
+    /**
+     * @brief Re-color only the buses touched by the changed breakers/disconnectors on top of
+     *  the previous run, re-elect the TopoND of every bus which has a CN whose topoID has
+     *  changed, re-emit the topo_connect rows of those CNs and re-run Frm_To_Cp from their
+     *  TopoNDs and the other ends of their branches.
+     *  It's not equivalent to a full run: the SDK can't delete the rows written by an
+     *  algorithm, so the TopoND, topo_connect and topoid_subid rows of the topoIDs which
+     *  vanish by a split or merge are left in the graph, see `staleTopoIDs`, and Frm_To_Cp
+     *  doesn't revisit the TopoNDs outside of the rebuilt buses.
+     * @param changedSwitches The vids of breakers/disconnectors whose status has changed.
+     * @param prev The snapshot of the previous run on the same graph.
+     */
+    void runDelta(const std::vector<NodeID> &changedSwitches, const NetworkTopoSnapshot &prev) {
+        buildCSR();
+        for (const auto &[vid, st] : prev.states) {
+            auto &dst = state(vid);
+            dst = st;
+            // Frm_To_Cp accumulates from zero when it's re-run below. sumBusQMeas and
+            // sumLineNo are only kept on the TopoNDs, which aren't in the snapshot.
+            dst.sumQimeas = 0.0;
+        }
+        seeds = prev.seeds;
+        equipmentSeeds = prev.equipmentSeeds;
+
+        // The buses touched by the changed switches are the only ones that could split or join
+        std::unordered_set<int64_t> busIDs;
+        for (auto sw : changedSwitches) {
+            refreshSwitchPoint(sw);
+            deltaVertices.push_back(sw);
+            for (auto cn : neighborIDs(sw, switchLabel)) {
+                if (seeds.count(cn)) {
+                    busIDs.emplace(state(cn).maxTopoID);
                 }
-                return tgts;
-            });
-
-            cnSet = bdSet.map([this, graph, &bdLabels, &sumCounter](NodeID s) {
-                auto sPoint = graph->getProperty(s, "point").getInt64();
-                if (sPoint != 1) return std::vector<NodeID>{};
-                auto tgts = graph->neighborIDs(s, [this, &bdLabels](const Edge &e) -> bool {
-                    for (auto &l : getEdgeLabelSet(e.getEdgeID())) {
-                        if (bdLabels.count(l)) {
-                            return true;
-                        }
-                    }
-                    return false;
-                });
-                for (auto t : tgts) {
-                    if (state(s).maxBDID > state(t).maxTopoID) {
-                        sumCounter++;
-                        // TODO(yee): data race
-                        auto newTopoId = state(t).maxTopoID + state(s).maxBDID;
-                        writeMax<int64_t>(&state(t).maxTopoID, newTopoId);
-                    }
+            }
+        }
+
+        std::unordered_map<NodeID, int64_t> oldTopoIDs;
+        std::vector<NodeID> region;
+        for (auto busID : busIDs) {
+            auto iter = prev.buses.find(busID);
+            if (iter == prev.buses.end()) continue;
+            for (auto cn : iter->second) {
+                oldTopoIDs.emplace(cn, state(cn).maxTopoID);
+                state(cn).maxTopoID = seeds.at(cn);
+                region.push_back(cn);
+            }
+        }
+        mergeBuses(VertexSubset(ctx_, region));
+
+        std::vector<NodeID> changedCNs;
+        for (const auto &[cn, topoID] : oldTopoIDs) {
+            if (state(cn).maxTopoID != topoID) {
+                changedCNs.push_back(cn);
+            }
+        }
+        if (changedCNs.empty()) {
+            return;
+        }
+        deltaVertices.insert(deltaVertices.end(), changedCNs.begin(), changedCNs.end());
+
+        // The TopoND of a bus is elected over all of its equipments, so a bus which has any
+        // changed CN is rebuilt as a whole, the CNs which kept their topoID included
+        std::unordered_set<int64_t> rebuiltTopoIDs;
+        for (auto cn : changedCNs) {
+            rebuiltTopoIDs.emplace(state(cn).maxTopoID);
+        }
+        std::vector<NodeID> busCNs;
+        for (auto cn : region) {
+            if (rebuiltTopoIDs.count(state(cn).maxTopoID)) {
+                busCNs.push_back(cn);
+            }
+        }
+        resetEquipmentSeeds(busCNs);
+
+        // The old topoIDs which no CN of the region has any more
+        std::unordered_set<int64_t> liveTopoIDs;
+        for (auto cn : region) {
+            liveTopoIDs.emplace(state(cn).maxTopoID);
+        }
+        std::set<int64_t> vanished;
+        for (const auto &[cn, topoID] : oldTopoIDs) {
+            if (!liveTopoIDs.count(topoID)) {
+                vanished.emplace(topoID);
+            }
+        }
+        staleTopoIDs.assign(vanished.begin(), vanished.end());
+
+        auto equipments = buildTopoNodes(VertexSubset(ctx_, std::move(busCNs)));
+        VertexSubset cnSet(ctx_, std::move(changedCNs));
+        deltaVertices.insert(
+                deltaVertices.end(), equipments.vids().begin(), equipments.vids().end());
+        buildTopoEdges(cnSet);
+        buildBranches(branchScope(cnSet));
+        // Frm_To_Cp walks the topo_* edges, so they must be in the graph by now
+        flushMutations();
+        setFrmToCp(rebuiltTopoNodes(equipments));
+    }
+
+    /**
+     * @brief Snapshot the topoID assignment for the later delta runs.
+     */
+    std::shared_ptr<NetworkTopoSnapshot> snapshot() const {
+        auto snap = std::make_shared<NetworkTopoSnapshot>();
+        snap->seeds = seeds;
+        snap->equipmentSeeds = equipmentSeeds;
+        for (const auto &[cn, seed] : seeds) {
+            snap->buses[state(cn).maxTopoID].push_back(cn);
+        }
+        const auto &index = vertexIndex();
+        for (uint32_t idx = 0; idx < index.size(); ++idx) {
+            const auto &st = stateAt(idx);
+            if (st.touched()) {
+                snap->states.emplace(index.vid(idx), st);
+            }
+        }
+        return snap;
+    }
+
+    /**
+     * @brief The fingerprint of the inputs of a run which change between the calls: the
+     *  discrete measurements, the status of the switches stored in the graph, the analog
+     *  measurements and the status/taps of the equipments, i.e. `kMeasuredProps`, and the
+     *  out-degree of each vertex for the structure of the graph. The TopoNDs and the edges
+     *  written by a run are left out, so the fingerprint taken before a run is the one of the
+     *  graph after it too. The hashes of the vertices are summed, so the fingerprint doesn't
+     *  depend on the order of the vertices.
+     */
+    uint64_t fingerprint() const {
+        const auto *graph = this->graph();
+        auto *engine = ctx_->engine();
+        auto hashVertex = [this, graph](NodeID vid) -> uint64_t {
+            if (hasNodeLabel(vid, topoNDLabel)) {
+                return 0;
+            }
+            uint64_t degree = 0;
+            for (auto [b, e] = graph->outEdges(vid); b != e; ++b) {
+                if (!hasEdgeLabel(*b, writtenEdgeLabel)) {
+                    ++degree;
+                }
+            }
+            if (hasNodeLabel(vid, discreteLabel)) {
+                return folly::hash::hash_combine(vid,
+                                                 degree,
+                                                 getProperty(vid, "updateFlag"),
+                                                 getProperty(vid, "flagM"),
+                                                 getProperty(vid, "statusM"),
+                                                 getProperty(vid, "status"));
+            }
+            uint64_t hash = folly::hash::hash_combine(vid, degree);
+            for (const auto *name : kMeasuredProps) {
+                hash = folly::hash::hash_combine(hash, getProperty(vid, name));
+            }
+            if (hasNodeLabel(vid, cnLabel)) {
+                for (auto sw : neighborIDs(vid, switchLabel)) {
+                    hash += folly::hash::hash_combine(vid, sw, getProperty(sw, "point"));
                 }
-                return tgts;
-            });
+            }
+            return hash;
+        };
+        auto vids = graph->nodeIDs();
+        auto hashes = engine->runOnCurrentThread(engine->parallelFor(vids, hashVertex));
+        return std::accumulate(hashes.begin(), hashes.end(), uint64_t{0});
+    }
+
+    /**
+     * @brief Get the result of the vertices updated by the delta run, followed by a row with a
+     *  null vid for each vanished topoID, whose TopoND, topo_connect and topoid_subid rows
+     *  are stale and left to the caller to delete.
+     */
+    void getDeltaResult(ResultTable *result) const {
+        std::unordered_set<NodeID> visited;
+        for (auto vid : deltaVertices) {
+            if (!visited.emplace(vid).second) continue;
+            Row row;
+            row.append(vid);
+            state(vid).getResult(row);
+            result->append(std::move(row));
         }
-        std::set<std::string> buildLabels = {
-                "connected_Bus_CN",
-                "connected_Load_CN",
-                "CN_tx_two",
-                "aclinedot_cn",
-                "CN_tx_three",
-                "connected_Compensator_P_CN",
+        for (auto topoID : staleTopoIDs) {
+            Row row;
+            row.append(NullValue::kNullValue);
+            row.append(topoID);
+            for (size_t i = 0; i < 3; ++i) {
+                row.append(NullValue::kNullValue);
+            }
+            result->append(std::move(row));
+        }
+    }
+
+    // The properties of the equipments a run reads which change without changing the
+    // structure of the graph: the measurements behind M_P_TLPF/M_Q_TLPF and the compensator
+    // Q, the off flags and the tap voltage `t` of the transformers
+    static constexpr const char *kMeasuredProps[] = {
+            "Pimeas",
+            "Qimeas",
+            "off",
+            "I_off",
+            "J_off",
+            "K_off",
+            "t",
+    };
+
+    // The number of scenarios evaluated in one pass, one per bit of a uint64_t
+    static constexpr size_t kScenarioLanes = 64;
+
+    /**
+     * @brief Evaluate the bus merging of switch-state scenarios on top of the previous run,
+     *  without writing the graph. Each scenario puts some breakers and disconnectors in the
+     *  given status and leaves the others as they are, and up to kScenarioLanes scenarios
+     *  are evaluated in one pass, one per bit of a lane mask.
+     * @param scenarios The target status of the breakers/disconnectors set by each scenario.
+     * @param prev The snapshot of the previous run on the same graph.
+     */
+    void runScenarios(const std::vector<std::vector<SwitchTarget>> &scenarios,
+                      const NetworkTopoSnapshot &prev) {
+        buildCSR();
+        for (const auto &[vid, st] : prev.states) {
+            state(vid) = st;
+        }
+        for (size_t first = 0; first < scenarios.size(); first += kScenarioLanes) {
+            auto last = std::min(scenarios.size(), first + kScenarioLanes);
+            evaluateScenarios(scenarios, first, last, prev);
+        }
+    }
+
+    /**
+     * @brief One row per CN whose topoID differs in a scenario: the scenario index, the CN,
+     *  its topoID after the previous run and its topoID in the scenario.
+     */
+    void getScenarioResult(ResultTable *result) const {
+        for (const auto &diff : scenarioDiffs) {
+            Row row;
+            row.append(static_cast<int64_t>(diff.scenario));
+            row.append(diff.cn);
+            row.append(diff.topoID);
+            row.append(diff.scenarioTopoID);
+            result->append(std::move(row));
+        }
+    }
+
+    std::string name() const override {
+        return "yj.network_topo";
+    }
+
+private:
+    // The equipment a TopoND is derived from, ranked by (0 for units else 1, vid)
+    using TopoNodeCandidate = std::pair<int32_t, NodeID>;
+    using TopoNodeRegistry = nebula::computing::EmitOnce<int64_t, TopoNodeCandidate>;
+    // The topoid_subid edges keyed by (topoID, substation id)
+    using TopoSubKey = std::pair<int64_t, int64_t>;
+    using TopoSubRegistry =
+            nebula::computing::EmitOnce<TopoSubKey, NodeID, folly::hasher<TopoSubKey>>;
+
+    /**
+     * @brief A branch read from the graph before its derived parameters are computed, with
+     *  the inputs of the kernel which are not kept in the record.
+     */
+    struct GatheredBranch {
+        TopoConnectRecord rec;
+        TopoConnectOverlay back;
+        double ih{0.0};
+        double s{0.0};
+    };
+
+    struct ScenarioDiff {
+        size_t scenario;
+        NodeID cn;
+        int64_t topoID;
+        int64_t scenarioTopoID;
+    };
+
+    /**
+     * @brief Resolve the status of breakers/disconnectors from the updated discrete
+     *  measurements.
+     */
+    void resolveSwitchPoints(const VertexSubset &disSetByFlag) {
+        VertexSubset breakerSet = disSetByFlag.map([this](NodeID s) {
+            int32_t delta = discreteStatus(s);
+            auto tgts = neighborIDs(s, discreteBreakerLabel);
+            for (auto t : tgts) {
+                write<int32_t>(&state(t).breakerPoint, delta);
+            }
+            return tgts;
+        });
+        breakerSet.forEach([this](NodeID t) { resolveBreakerPoint(t); });
+
+        VertexSubset disSet = disSetByFlag.map([this](NodeID s) {
+            int32_t delta = discreteStatus(s);
+            auto tgts = neighborIDs(s, discreteDisLabel);
+            for (auto t : tgts) {
+                write<int32_t>(&state(t).disPoint, delta);
+            }
+            return tgts;
+        });
+        disSet.forEach([this](NodeID s) { resolveDisconnectorPoint(s); });
+    }
+
+    /**
+     * @brief The switch status measured by the discrete vertex.
+     */
+    int32_t discreteStatus(NodeID s) const {
+        auto flagM = getProperty(s, "flagM");
+        auto statusM = getProperty(s, "statusM");
+        auto status = getProperty(s, "status");
+        return flagM.getInt64() == 1 ? statusM.getInt64() : status.getInt64();
+    }
+
+    void resolveBreakerPoint(NodeID t) {
+        auto name = getProperty(t, "name").getString();
+        int64_t point = -1;
+        static auto names = std::unordered_set<String>{
+                "四川.桃坪厂/13.8kV.2开关",
+                "四川.桃坪厂/13.8kV.3开关",
+                "阿坝.岷江电化站/110kV.151开关",
+                "阿坝.岷江电化站/10kV.1#主变低压侧901开关",
         };
-        VertexSubset buildTP = cnTotal.map([this, graph, &buildLabels](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this, &buildLabels](const Edge &e) -> bool {
-                for (auto &l : getEdgeLabelSet(e.getEdgeID())) {
-                    if (buildLabels.count(l)) {
-                        return true;
-                    }
-                }
-                return false;
-            });
+        if (names.count(name)) {
+            point = 1;
+        } else if (name == "广元.太公电铁站/110kV.102开关") {
+            point = 0;
+        } else {
+            point = state(t).breakerPoint;
+        }
+        // TODO(yee): in-place update in the memory graph
+        state(t).point = point;
+    }
+
+    void resolveDisconnectorPoint(NodeID s) {
+        auto name = getProperty(s, "name").getString();
+        int64_t point = -1;
+        static auto names = std::unordered_set<String>{
+                "四川.瀑布沟厂/500kV.50126刀闸",
+                "四川.瀑布沟厂/500kV.50526刀闸",
+                "四川.红房子厂/220kV.2516刀闸",
+                "四川.红房子厂/220kV.2516刀闸",
+        };
+        if (names.count(name)) {
+            point = 1;
+        } else if (name == "广元.太公电铁站/110kV.1021刀闸") {
+            point = 0;
+        } else {
+            point = state(s).disPoint;
+        }
+        // TODO(yee): in-place update in the memory graph
+        state(s).point = point;
+    }
+
+    /**
+     * @brief Build the TopoND of each bus from the equipments connected to its CNs.
+     * @return The equipments connected to the CNs.
+     */
+    VertexSubset buildTopoNodes(const VertexSubset &cnTotal) {
+        const auto &buildMask = busEquipmentLabel;
+        // Many CNs collapse into one bus, so elect one equipment per topoID to derive its
+        // TopoND from, the units first since they carry the reactive power limits
+        TopoNodeRegistry topoNodes;
+        VertexSubset buildTP = cnTotal.map([this, &buildMask, &topoNodes](NodeID s) {
+            auto tgts = neighborIDs(s, buildMask);
             for (auto t : tgts) {
                 if (state(t).maxTopoID == state(s).maxTopoID) {
-                    insertNode("TopoND",
-                               {
-                                       {"topoid", state(s).maxTopoID},
-                                       {"TOPOID", state(s).maxTopoID},
-                                       {"bus_name", graph->getProperty(t, "name")},
-                                       {"base_kV", graph->getProperty(t, "volt")},
-                                       {"desired_volts", graph->getProperty(t, "base_value")},
-                                       {"up_V", 1.1},
-                                       {"lo_V", 0.9},
-                                       {"Ri_vP", 0},
-                                       {"Ri_vQ", 0},
-                                       {"start_pt", 0.0},
-                                       {"nodeSI", 0.0},
-                                       {"nodeCSeverity", 1},
-                                       {"ZJP", 1},
-                                       {"ZJQ", 0},
-                               });
+                    topoNodes.offer(state(s).maxTopoID, {1, t});
                 } else {
                     write<int64_t>(&state(t).maxTopoID, state(s).maxTopoID);
                 }
@@ -352,37 +658,11 @@ public:
         // post-accum
         buildTP.forEach([this](NodeID t) { state(t).topoID = state(t).maxTopoID; });
 
-        VertexSubset buildTPUnit = cnTotal.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                for (auto &l : getEdgeLabelSet(e.getEdgeID())) {
-                    if (l == "connected_Unit_CN") {
-                        return true;
-                    }
-                }
-                return false;
-            });
-            std::vector<Node> nodes;
+        VertexSubset buildTPUnit = cnTotal.map([this, &topoNodes](NodeID s) {
+            auto tgts = neighborIDs(s, unitCNLabel);
             for (auto t : tgts) {
                 if (state(t).maxTopoID == state(s).maxTopoID) {
-                    insertNode("TopoND",
-                               {
-                                       {"topoid", state(s).maxTopoID},
-                                       {"TOPOID", state(s).maxTopoID},
-                                       {"bus_name", graph->getProperty(t, "name")},
-                                       {"base_kV", graph->getProperty(t, "volt")},
-                                       {"desired_volts", graph->getProperty(t, "base_value")},
-                                       {"up_V", 1.1},
-                                       {"lo_V", 0.9},
-                                       {"qUp", graph->getProperty(t, "Q_max") / 100},
-                                       {"qLower", graph->getProperty(t, "Q_min") / 100},
-                                       {"Ri_vP", 0},
-                                       {"Ri_vQ", 0},
-                                       {"start_pt", 0.0},
-                                       {"nodeSI", 0.0},
-                                       {"nodeCSeverity", 1},
-                                       {"ZJP", 1},
-                                       {"ZJQ", 0},
-                               });
+                    topoNodes.offer(state(s).maxTopoID, {0, t});
                 } else {
                     write<int64_t>(&state(t).maxTopoID, state(s).maxTopoID);
                 }
@@ -391,52 +671,66 @@ public:
         });
         buildTPUnit.forEach([this](NodeID t) { state(t).topoID = state(t).maxTopoID; });
 
-        VertexSubset totalTopoNodes = tNeutralPoint.filter([graph](NodeID t) {
-            auto iOff = graph->getProperty(t, "I_off").getInt64();
-            auto kOff = graph->getProperty(t, "K_off").getInt64();
-            auto jOff = graph->getProperty(t, "J_off").getInt64();
-            return iOff + kOff + jOff <= 1;
-        });
-        totalTopoNodes.forEach([this, graph](NodeID t) {
-            auto midPoint = graph->getProperty(t, "middle_point").getInt64();
-            insertNode("TopoND",
-                       {
-                               {"topoid", midPoint},
-                               {"TOPOID", midPoint},
-                               {"bus_name", graph->getProperty(t, "name")},
-                               {"base_kV", 1},
-                               {"desired_volts", 1},
-                               {"up_V", 1.1},
-                               {"lo_V", 0.9},
-                               {"Ri_vP", 0},
-                               {"Ri_vQ", 0},
-                               {"start_pt", 0.0},
-                               {"nodeSI", 0.0},
-                               {"nodeCSeverity", 1},
-                               {"ZJP", 1},
-                               {"ZJQ", 0},
-                       });
-            insertEdge("topo_neutral", {midPoint}, {midPoint});
+        std::vector<std::pair<int64_t, TopoNodeCandidate>> elected;
+        elected.reserve(topoNodes.size());
+        topoNodes.forEach([&elected](int64_t topoID, const TopoNodeCandidate &candidate) {
+            elected.emplace_back(topoID, candidate);
         });
+        auto emitOne = [this](const auto &entry) {
+            const auto &[topoID, candidate] = entry;
+            auto t = candidate.second;
+            properties_type props = {
+                    {"topoid", topoID},
+                    {"TOPOID", topoID},
+                    {"bus_name", getProperty(t, "name")},
+                    {"base_kV", getProperty(t, "volt")},
+                    {"desired_volts", getProperty(t, "base_value")},
+                    {"up_V", 1.1},
+                    {"lo_V", 0.9},
+                    {"Ri_vP", 0},
+                    {"Ri_vQ", 0},
+                    {"start_pt", 0.0},
+                    {"nodeSI", 0.0},
+                    {"nodeCSeverity", 1},
+                    {"ZJP", 1},
+                    {"ZJQ", 0},
+            };
+            if (candidate.first == 0) {
+                props.emplace("qUp", getProperty(t, "Q_max") / 100);
+                props.emplace("qLower", getProperty(t, "Q_min") / 100);
+            }
+            emitNode("TopoND", std::move(props));
+        };
+        auto engine = ctx_->engine();
+        engine->runOnCurrentThread(engine->parallelFor(elected, emitOne));
+
+        return buildTP.merge(buildTPUnit);
+    }
 
+    /**
+     * @brief Connect the TopoND of each bus to its substation and equipments.
+     */
+    void buildTopoEdges(const VertexSubset &cnTotal) {
+        TopoSubRegistry topoSubs;
         VertexSubset topoSub =
-                cnTotal.filter([this, graph](NodeID s) {
-                           auto cnID = graph->getProperty(s, "CN_id").getInt64();
+                cnTotal.filter([this](NodeID s) {
+                           auto cnID = getProperty(s, "CN_id").getInt64();
                            return state(s).maxTopoID != 0 && state(s).maxTopoID != cnID;
                        })
-                        .map([this, graph](NodeID s) {
-                            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                                const auto &ls = getEdgeLabelSet(e.getEdgeID());
-                                return ls.count("cn_subid");
-                            });
+                        .map([this, &topoSubs](NodeID s) {
+                            auto tgts = neighborIDs(s, cnSubidLabel);
                             for (auto t : tgts) {
-                                auto tid = graph->getProperty(t, "id").getInt64();
-                                insertEdge("topoid_subid", {state(s).maxTopoID}, {tid});
+                                auto tid = getProperty(t, "id").getInt64();
+                                auto sid = state(s).maxTopoID;
+                                // One edge per bus rather than per CN of it
+                                if (topoSubs.offer({sid, tid}, t)) {
+                                    emitEdge("topoid_subid", {sid}, {tid});
+                                }
                             }
                             return tgts;
                         });
+        profiler().lap("topoSub", cnTotal.size(), topoSub.size());
 
-        VertexSubset checkNode3 = verticesByAllLabels(all, {"TopoND"});
         std::set<std::string> componentLabels = {
                 "connected_Unit_CN",
                 "connected_Load_CN",
@@ -446,54 +740,54 @@ public:
                 "CN_tx_three",
                 "aclinedot_cn",
         };
+        auto componentMask = labelMask(componentLabels);
         VertexSubset topoComponentNode =
                 cnTotal.filter([this](NodeID s) { return state(s).maxTopoID != 0; })
-                        .map([this, graph, &componentLabels](NodeID s) {
-                            auto f = [this, &componentLabels](const Edge &e) -> bool {
-                                for (auto &l : getEdgeLabelSet(e.getEdgeID())) {
-                                    if (componentLabels.count(l)) {
-                                        return true;
-                                    }
-                                }
-                                return false;
-                            };
-                            auto tgts = graph->neighborIDs(s, f);
+                        .map([this, &componentMask](NodeID s) {
+                            auto tgts = neighborIDs(s, componentMask);
                             for (auto t : tgts) {
-                                auto tname = graph->getProperty(t, "typename").getString();
-                                auto tid = graph->getProperty(t, "id").getInt64();
+                                auto tname = getProperty(t, "typename").getString();
+                                auto tid = getProperty(t, "id").getInt64();
                                 auto sid = state(s).maxTopoID;
                                 if (tname == "Unit") {
-                                    insertEdge("topo_unit", {sid}, {tid});
+                                    emitEdge("topo_unit", {sid}, {tid});
                                 } else if (tname == "Load") {
-                                    insertEdge("topo_load", {sid}, {tid});
+                                    emitEdge("topo_load", {sid}, {tid});
                                 } else if (tname == "Bus") {
-                                    insertEdge("topo_bus", {sid}, {tid});
+                                    emitEdge("topo_bus", {sid}, {tid});
                                 } else if (tname == "Compensator_P") {
-                                    insertEdge("topo_compensatorP", {sid}, {tid});
+                                    emitEdge("topo_compensatorP", {sid}, {tid});
                                 } else if (tname == "two_port_transformer") {
-                                    insertEdge("topo_Tx_Two", {sid}, {tid});
+                                    emitEdge("topo_Tx_Two", {sid}, {tid});
                                 } else if (tname == "three_port_transformer") {
-                                    insertEdge("topo_Tx_Three", {sid}, {tid});
+                                    emitEdge("topo_Tx_Three", {sid}, {tid});
                                 } else if (tname == "AClinedot") {
-                                    insertEdge("topo_aclinedot", {sid}, {tid});
+                                    emitEdge("topo_aclinedot", {sid}, {tid});
                                 }
                             }
                             return tgts;
                         });
+        profiler().lap("topoComponentNode", cnTotal.size(), topoComponentNode.size());
+    }
+
+    /**
+     * @brief Build the topo_connect branches of CS lines, AC lines and two/three-port
+     *  transformers connected to the given CNs.
+     */
+    void buildBranches(const VertexSubset &cnOpenSub) {
+        auto *graph = this->graph();
 
-        VertexSubset csOpenSub = cnOpenSub.map([this, graph](NodeID s) {
-            auto cnID = graph->getProperty(s, "CN_id").getInt64();
+        VertexSubset csOpenSub = cnOpenSub.map([this](NodeID s) {
+            auto cnID = getProperty(s, "CN_id").getInt64();
             std::unordered_set<NodeID> res;
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Compensator_S_CN");
-            });
+            auto tgts = neighborIDs(s, compensatorSCNLabel);
             res.reserve(tgts.size());
             for (auto t : tgts) {
-                auto off = graph->getProperty(t, "off").getInt64();
+                auto off = getProperty(t, "off").getInt64();
                 if (off == 0) {
                     res.emplace(t);
-                    auto iND = graph->getProperty(t, "I_nd").getInt64();
-                    auto jND = graph->getProperty(t, "J_nd").getInt64();
+                    auto iND = getProperty(t, "I_nd").getInt64();
+                    auto jND = getProperty(t, "J_nd").getInt64();
                     if (iND == cnID) {
                         write<int>(&state(t).sumIID, state(s).maxTopoID);
                     } else if (jND == cnID) {
@@ -503,6 +797,7 @@ public:
             }
             return std::vector<NodeID>{res.begin(), res.end()};
         });
+        profiler().lap("csOpenSub", cnOpenSub.size(), csOpenSub.size());
 
         VertexSubset insertLineCS =
                 csOpenSub
@@ -510,1152 +805,411 @@ public:
                             auto iid = state(s).sumIID, jid = state(s).sumJID;
                             return iid != jid && iid != 0 && jid != 0;
                         })
-                        .forEach([this, graph](NodeID s) {
+                        .forEach([this](NodeID s) {
                             auto iid = state(s).sumIID;
                             auto jid = state(s).sumJID;
-                            auto sname = graph->getProperty(s, "name").getString();
-                            auto csZK = graph->getProperty(s, "cs_ZK").getDouble();
-                            auto volt =
-                                    std::to_string(graph->getProperty(s, "volt").getDouble());
-                            insertEdge("topo_connect",
-                                       {iid},
-                                       {jid},
-                                       {
-                                               {"edge_name", List({sname})},
-                                               {"area", List({sname})},
-                                               {"tap_bus", iid},
-                                               {"z_bus", jid},
-                                               {"R", List({0})},
-                                               {"X", List({csZK})},
-                                               {"line_Q1_list", List({200})},
-                                               {"line_Q2_list", List({250})},
-                                               {"line_Q3_list", List({300})},
-                                               {"B_list", List({1 / csZK})},
-                                               {"BIJ_list", List({1 / csZK})},
-                                               {"reverse", 1},
-                                               {"Decision", List({0})},
-                                               {"Analysis_decision", List({0})},
-                                               {"volt", volt},
-                                               {"device_type", "CS传输线"},
-                                               {"CSeverity", List({-1})},
-                                               {"B", 1 / csZK},
-                                               {"BIJ", 1 / csZK},
-                                               {"line_Q1", 200},
-                                               {"line_Q2", 250},
-                                               {"line_Q3", 300},
-                                               {"from_off", List({0})},
-                                               {"to_off", List({0})},
-                                       });
-                            insertEdge("topo_connect",
-                                       {jid},
-                                       {iid},
-                                       {
-                                               {"edge_name", List({sname})},
-                                               {"area", List({sname})},
-                                               {"tap_bus", iid},
-                                               {"z_bus", jid},
-                                               {"R", List({0})},
-                                               {"X", List({csZK})},
-                                               {"line_Q1_list", List({200})},
-                                               {"line_Q2_list", List({250})},
-                                               {"line_Q3_list", List({300})},
-                                               {"B_list", List({1 / csZK})},
-                                               {"BIJ_list", List({1 / csZK})},
-                                               {"reverse", -1},
-                                               {"Decision", List({0})},
-                                               {"Analysis_decision", List({0})},
-                                               {"volt", volt},
-                                               {"device_type", "CS传输线"},
-                                               {"CSeverity", List({-1})},
-                                               {"B", 1 / csZK},
-                                               {"BIJ", 1 / csZK},
-                                               {"line_Q1", 200},
-                                               {"line_Q2", 250},
-                                               {"line_Q3", 300},
-                                               {"from_off", List({0})},
-                                               {"to_off", List({0})},
-                                       });
+                            auto sname = getProperty(s, "name").getString();
+                            auto csZK = getProperty(s, "cs_ZK").getDouble();
+                            auto volt = getProperty(s, "volt").getDouble();
+                            auto rec = TopoConnectRecord::branch(
+                                    BranchKind::kCSLine, iid, jid, 0, csZK);
+                            rec.b = 1 / csZK;
+                            rec.name = sname;
+                            rec.voltFrom = volt;
+                            emitEdgePair("topo_connect", std::move(rec), TopoConnectOverlay{});
                         })
                         .forEach([this](NodeID s) {
                             state(s).itopoID = state(s).sumIID;
                             state(s).jtopoID = state(s).sumJID;
                         });
+        profiler().lap("insertLineCS", csOpenSub.size(), insertLineCS.size());
         VertexSubset aclineOpenSub =
                 cnOpenSub
-                        .map([this, graph](NodeID s) {
-                            return graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                                return getEdgeLabelSet(e.getEdgeID()).count("aclinedot_cn");
-                            });
+                        .map([this](NodeID s) {
+                            return neighborIDs(s, aclinedotCNLabel);
                         })
-                        .filter([graph](NodeID t) {
-                            return graph->getProperty(t, "off").getInt64() == 0;
+                        .filter([this](NodeID t) {
+                            return getProperty(t, "off").getInt64() == 0;
                         });
-        VertexSubset g3 = aclineOpenSub.map([this, graph](NodeID s) {
+        profiler().lap("aclineOpenSub", cnOpenSub.size(), aclineOpenSub.size());
+        auto gatherACLines = [this, graph](NodeID s) {
+            std::vector<GatheredBranch> res;
             if (state(s).maxTopoID == 0) {
-                return std::vector<NodeID>{};
+                return res;
             }
-            auto sPimeas = graph->getProperty(s, "Pimeas").getDouble();
-            auto sQimeas = graph->getProperty(s, "Qimeas").getDouble();
-            bool valid = false;
+            auto sPimeas = getProperty(s, "Pimeas").getDouble();
+            auto sQimeas = getProperty(s, "Qimeas").getDouble();
             auto [b, e] = graph->outEdges(s);
             for (; b != e; ++b) {
                 auto t = b.getDstID();
                 if (state(t).maxTopoID != 0) {
-                    valid = true;
-
-                    auto id = graph->getProperty(*b, "id").getInt64();
-                    auto ename = graph->getProperty(*b, "name").getString();
-                    auto lineR = graph->getProperty(*b, "line_R").getDouble();
-                    auto lineX = graph->getProperty(*b, "line_X").getDouble();
-                    auto lineB = graph->getProperty(*b, "line_B").getDouble();
-                    auto volt = graph->getProperty(*b, "volt").getDouble();
-                    auto ih = graph->getProperty(*b, "Ih").getDouble();
-                    // auto ratio = lineR / lineX;
-                    auto normalLimit = sqrt(3) * volt * ih / 1000 / 100;
-                    auto emerLimit = 1.1 * std::sqrt(3) * volt * ih / 1000 / 100;
-                    auto ldshdLimit = 1.2 * std::sqrt(3) * volt * ih / 1000 / 100;
-                    int non_reverse = 1;
-                    if (normalLimit < 0.1) {
-                        normalLimit = 9999;
-                        emerLimit = 9999;
-                        ldshdLimit = 9999;
-                    }
-                    if (state(s).maxTopoID < state(t).maxTopoID) {
-                        non_reverse = -1;
-                    }
-
-                    auto tPimeas = graph->getProperty(t, "Pimeas").getDouble();
-                    auto tQimeas = graph->getProperty(t, "Qimeas").getDouble();
-
-                    if (lineR < 0) {
-                        insertEdge("topo_connect",
-                                   {state(s).maxTopoID},
-                                   {state(t).maxTopoID},
-                                   {
-                                           {"edge_name", ename},
-                                           {"area", ename},
-                                           {"tap_bus", state(s).maxTopoID},
-                                           {"z_bus", state(t).maxTopoID},
-                                           {"flag", 0},
-                                           {"R", List({-lineR})},
-                                           {"X", List({lineX})},
-                                           {"hB_list", List({lineB})},
-                                           {"line_Q1_list", List({normalLimit})},
-                                           {"line_Q2_list", List({emerLimit})},
-                                           {"line_Q3_list", List({ldshdLimit})},
-                                           {"control_bus", 0},
-                                           {"side", 0},
-                                           {"min_tap", 0},
-                                           {"max_tap", 0},
-                                           {"step_size", 0},
-                                           {"M_P_TLPF_list", List({sPimeas / 100})},
-                                           {"M_Q_TLPF_list", List({sQimeas / 100})},
-                                           {"outage", 0},
-                                           {"G_list",
-                                            List({-lineR / (lineR * lineR + lineX * lineX)})},
-                                           {"B_list",
-                                            List({lineX / (lineR * lineR + lineX * lineX)})},
-                                           {"BIJ_list", List({1 / lineX})},
-                                           {"kcount", state(s).sumAclineCount},
-                                           {"reverse", non_reverse},
-                                           {"Decision", List({0})},
-                                           {"Analysis_decision", List({0})},
-                                           {"volt", std::to_string(volt)},
-                                           {"device_type", "AC传输线"},
-                                           {"CSeverity", List({-1})},
-                                           {"hB", lineB},
-                                           {"G", -lineR / (lineR * lineR + lineX * lineX)},
-                                           {"B", lineX / (lineR * lineR + lineX * lineX)},
-                                           {"BIJ", 1 / lineX},
-                                           {"M_P_TLPF", sPimeas / 100},
-                                           {"M_Q_TLPF", sQimeas / 100},
-                                           {"line_Q1", normalLimit},
-                                           {"line_Q2", emerLimit},
-                                           {"line_Q3", ldshdLimit},
-                                           {"key_list", List({id})},
-                                           {"from_off", List({0})},
-                                           {"to_off", List({0})},
-                                   });
-                        insertEdge("topo_connect",
-                                   {state(t).maxTopoID},
-                                   {state(s).maxTopoID},
-                                   {
-                                           {"edge_name", ename},
-                                           {"area", ename},
-                                           {"tap_bus", state(t).maxTopoID},
-                                           {"z_bus", state(s).maxTopoID},
-                                           {"flag", 0},
-                                           {"R", List({-lineR})},
-                                           {"X", List({lineX})},
-                                           {"hB_list", List({lineB})},
-                                           {"line_Q1_list", List({normalLimit})},
-                                           {"line_Q2_list", List({emerLimit})},
-                                           {"line_Q3_list", List({ldshdLimit})},
-                                           {"control_bus", 0},
-                                           {"side", 0},
-                                           {"min_tap", 0},
-                                           {"max_tap", 0},
-                                           {"step_size", 0},
-                                           {"M_P_TLPF_list", List({tPimeas / 100})},
-                                           {"M_Q_TLPF_list", List({tQimeas / 100})},
-                                           {"outage", 0},
-                                           {"G_list",
-                                            List({-lineR / (lineR * lineR + lineX * lineX)})},
-                                           {"B_list",
-                                            List({lineX / (lineR * lineR + lineX * lineX)})},
-                                           {"BIJ_list", List({1 / lineX})},
-                                           {"kcount", state(s).sumAclineCount},
-                                           {"reverse", -non_reverse},
-                                           {"Decision", List({0})},
-                                           {"Analysis_decision", List({0})},
-                                           {"volt", std::to_string(volt)},
-                                           {"device_type", "AC传输线"},
-                                           {"CSeverity", List({-1})},
-                                           {"hB", lineB},
-                                           {"G", -lineR / (lineR * lineR + lineX * lineX)},
-                                           {"B", lineX / (lineR * lineR + lineX * lineX)},
-                                           {"BIJ", 1 / lineX},
-                                           {"M_P_TLPF", tPimeas / 100},
-                                           {"M_Q_TLPF", tQimeas / 100},
-                                           {"line_Q1", normalLimit},
-                                           {"line_Q2", emerLimit},
-                                           {"line_Q3", ldshdLimit},
-                                           {"key_list", List({-id})},
-                                           {"from_off", List({0})},
-                                           {"to_off", List({0})},
-                                   });
-                    } else {
-                        insertEdge("topo_connect",
-                                   {state(s).maxTopoID},
-                                   {state(t).maxTopoID},
-                                   {
-                                           {"edge_name", ename},
-                                           {"area", ename},
-                                           {"tap_bus", state(s).maxTopoID},
-                                           {"z_bus", state(t).maxTopoID},
-                                           {"flag", 0},
-                                           {"R", List({lineR})},
-                                           {"X", List({lineX})},
-                                           {"hB_list", List({lineB})},
-                                           {"line_Q1_list", List({normalLimit})},
-                                           {"line_Q2_list", List({emerLimit})},
-                                           {"line_Q3_list", List({ldshdLimit})},
-                                           {"control_bus", 0},
-                                           {"side", 0},
-                                           {"min_tap", 0},
-                                           {"max_tap", 0},
-                                           {"step_size", 0},
-                                           {"M_P_TLPF_list", List({sPimeas / 100})},
-                                           {"M_Q_TLPF_list", List({sQimeas / 100})},
-                                           {"outage", 0},
-                                           {"G_list",
-                                            List({lineR / (lineR * lineR + lineX * lineX)})},
-                                           {"B_list",
-                                            List({lineX / (lineR * lineR + lineX * lineX)})},
-                                           {"BIJ_list", List({1 / lineX})},
-                                           {"kcount", state(s).sumAclineCount},
-                                           {"reverse", non_reverse},
-                                           {"Decision", List({0})},
-                                           {"Analysis_decision", List({0})},
-                                           {"volt", std::to_string(volt)},
-                                           {"device_type", "AC传输线"},
-                                           {"CSeverity", List({-1})},
-                                           {"hB", lineB},
-                                           {"G", lineR / (lineR * lineR + lineX * lineX)},
-                                           {"B", lineX / (lineR * lineR + lineX * lineX)},
-                                           {"BIJ", 1 / lineX},
-                                           {"M_P_TLPF", sPimeas / 100},
-                                           {"M_Q_TLPF", sQimeas / 100},
-                                           {"line_Q1", normalLimit},
-                                           {"line_Q2", emerLimit},
-                                           {"line_Q3", ldshdLimit},
-                                           {"key_list", List({id})},
-                                           {"from_off", List({0})},
-                                           {"to_off", List({0})},
-                                   });
-                        insertEdge("topo_connect",
-                                   {state(t).maxTopoID},
-                                   {state(s).maxTopoID},
-                                   {
-                                           {"edge_name", ename},
-                                           {"area", ename},
-                                           {"tap_bus", state(t).maxTopoID},
-                                           {"z_bus", state(s).maxTopoID},
-                                           {"flag", 0},
-                                           {"R", List({lineR})},
-                                           {"X", List({lineX})},
-                                           {"hB_list", List({lineB})},
-                                           {"line_Q1_list", List({normalLimit})},
-                                           {"line_Q2_list", List({emerLimit})},
-                                           {"line_Q3_list", List({ldshdLimit})},
-                                           {"control_bus", 0},
-                                           {"side", 0},
-                                           {"min_tap", 0},
-                                           {"max_tap", 0},
-                                           {"step_size", 0},
-                                           {"M_P_TLPF_list", List({tPimeas / 100})},
-                                           {"M_Q_TLPF_list", List({tQimeas / 100})},
-                                           {"outage", 0},
-                                           {"G_list",
-                                            List({lineR / (lineR * lineR + lineX * lineX)})},
-                                           {"B_list",
-                                            List({lineX / (lineR * lineR + lineX * lineX)})},
-                                           {"BIJ_list", List({1 / lineX})},
-                                           {"kcount", state(s).sumAclineCount},
-                                           {"reverse", -non_reverse},
-                                           {"Decision", List({0})},
-                                           {"Analysis_decision", List({0})},
-                                           {"volt", std::to_string(volt)},
-                                           {"device_type", "AC传输线"},
-                                           {"CSeverity", List({-1})},
-                                           {"hB", lineB},
-                                           {"G", lineR / (lineR * lineR + lineX * lineX)},
-                                           {"B", lineX / (lineR * lineR + lineX * lineX)},
-                                           {"BIJ", 1 / lineX},
-                                           {"M_P_TLPF", tPimeas / 100},
-                                           {"M_Q_TLPF", tQimeas / 100},
-                                           {"line_Q1", normalLimit},
-                                           {"line_Q2", emerLimit},
-                                           {"line_Q3", ldshdLimit},
-                                           {"key_list", List({-id})},
-                                           {"from_off", List({0})},
-                                           {"to_off", List({0})},
-                                   });
-                    }
+                    auto id = getProperty(*b, "id").getInt64();
+                    auto lineR = getProperty(*b, "line_R").getDouble();
+                    auto lineX = getProperty(*b, "line_X").getDouble();
+                    auto tPimeas = getProperty(t, "Pimeas").getDouble();
+                    auto tQimeas = getProperty(t, "Qimeas").getDouble();
+
+                    GatheredBranch branch;
+                    auto &rec = branch.rec;
+                    rec = TopoConnectRecord::impedance(BranchKind::kACLine,
+                                                       state(s).maxTopoID,
+                                                       state(t).maxTopoID,
+                                                       lineR,
+                                                       lineX);
+                    rec.name = getProperty(*b, "name").getString();
+                    rec.voltFrom = getProperty(*b, "volt").getDouble();
+                    rec.key = id;
+                    rec.kcount = state(s).sumAclineCount;
+                    rec.hB = getProperty(*b, "line_B").getDouble();
+                    rec.mP = sPimeas / 100;
+                    rec.mQ = sQimeas / 100;
+                    branch.back = TopoConnectOverlay{-id, tPimeas / 100, tQimeas / 100};
+                    branch.ih = getProperty(*b, "Ih").getDouble();
+                    res.emplace_back(std::move(branch));
                 }
             }
-            return valid ? std::vector<NodeID>{s} : std::vector<NodeID>{};
-        });
+            return res;
+        };
 
         ///////////////////////// Insert for two_port transformer ID //////////////////////
 
         VertexSubset x1 =
                 cnOpenSub
-                        .map([this, graph](NodeID s) {
-                            return graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                                return getEdgeLabelSet(e.getEdgeID()).count("CN_tx_two");
-                            });
+                        .map([this](NodeID s) {
+                            return neighborIDs(s, cnTxTwoLabel);
                         })
-                        .filter([graph](NodeID t) {
-                            return graph->getProperty(t, "off").getInt64() == 0;
+                        .filter([this](NodeID t) {
+                            return getProperty(t, "off").getInt64() == 0;
                         });
+        profiler().lap("x1", cnOpenSub.size(), x1.size());
 
-        VertexSubset x2 = x1.map([this, graph](NodeID s) {
+        auto gatherTxTwo = [this](NodeID s) {
+            std::vector<GatheredBranch> res;
             if (state(s).maxTopoID == 0) {
-                return std::vector<NodeID>{};
+                return res;
             }
-            auto sid = graph->getProperty(s, "id").getInt64();
-            auto sname = graph->getProperty(s, "name").getString();
-            auto svolt = graph->getProperty(s, "volt").getDouble();
-            auto rstar = graph->getProperty(s, "Rstar").getDouble();
-            auto xstar = graph->getProperty(s, "Xstar").getDouble();
-            auto itapL = graph->getProperty(s, "itapL").getDouble();
-            auto itapH = graph->getProperty(s, "itapH").getDouble();
-            auto itapC = graph->getProperty(s, "itapC").getDouble();
-            auto sPimeas = graph->getProperty(s, "Pimeas").getDouble();
-            auto sQimeas = graph->getProperty(s, "Qimeas").getDouble();
-            auto st = graph->getProperty(s, "t").getDouble();
-            auto ss = graph->getProperty(s, "S").getDouble();
-            double ratio = rstar / xstar;
-            UNUSED(ratio);
-            auto tgts = graph->outNeighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("txI_txJ_transformerline");
-            });
+            auto sid = getProperty(s, "id").getInt64();
+            auto sname = getProperty(s, "name").getString();
+            auto svolt = getProperty(s, "volt").getDouble();
+            auto rstar = getProperty(s, "Rstar").getDouble();
+            auto xstar = getProperty(s, "Xstar").getDouble();
+            auto itapL = getProperty(s, "itapL").getDouble();
+            auto itapH = getProperty(s, "itapH").getDouble();
+            auto itapC = getProperty(s, "itapC").getDouble();
+            auto sPimeas = getProperty(s, "Pimeas").getDouble();
+            auto sQimeas = getProperty(s, "Qimeas").getDouble();
+            auto st = getProperty(s, "t").getDouble();
+            auto ss = getProperty(s, "S").getDouble();
+            auto tgts = neighborIDs(s, transformerLineLabel, EdgeDirection::kOutEdge);
             for (auto t : tgts) {
                 if (state(t).maxTopoID != 0) {
-                    auto off = graph->getProperty(t, "off").getInt64();
+                    auto off = getProperty(t, "off").getInt64();
                     if (off == 0) {
-                        auto tt = graph->getProperty(t, "t").getDouble();
-                        auto tvolt = graph->getProperty(t, "volt").getDouble();
-                        auto tid = graph->getProperty(t, "id").getInt64();
+                        auto tt = getProperty(t, "t").getDouble();
+                        auto tvolt = getProperty(t, "volt").getDouble();
+                        auto tid = getProperty(t, "id").getInt64();
 
-                        auto tPimeas = graph->getProperty(t, "Pimeas").getDouble();
-                        auto tQimeas = graph->getProperty(t, "Qimeas").getDouble();
+                        auto tPimeas = getProperty(t, "Pimeas").getDouble();
+                        auto tQimeas = getProperty(t, "Qimeas").getDouble();
 
                         double tapRatio = st / tt;
                         if (tapRatio < 1.0) {
                             tapRatio = 1.0;
                         }
-                        double normalLimit = ss / 100;
-                        double emerLimit = 1.1 * normalLimit;
-                        double ldshdLimit = 1.2 * normalLimit;
-
-                        int non_reverse = 1;
-                        if (normalLimit < 0.1) {
-                            normalLimit = 9999;
-                            emerLimit = 9999;
-                            ldshdLimit = 9999;
-                        }
-                        if (state(s).maxTopoID < state(t).maxTopoID) {
-                            non_reverse = -1;
-                        }
 
-                        if (rstar < 0) {
-                            insertEdge(
-                                    "topo_connect",
-                                    {state(s).maxTopoID},
-                                    {state(t).maxTopoID},
-                                    {
-                                            {"edge_name", sname},
-                                            {"area", sname},
-                                            {"tap_bus", state(s).maxTopoID},
-                                            {"z_bus", state(t).maxTopoID},
-                                            {"flag", 1},
-                                            {"R", List({-rstar})},
-                                            {"X", List({xstar})},
-                                            {"hB_list", List({0})},
-                                            {"line_Q1_list", List({normalLimit})},
-                                            {"line_Q2_list", List({emerLimit})},
-                                            {"line_Q3_list", List({ldshdLimit})},
-                                            {"transformer_final_turns_ratio_list",
-                                             List({tapRatio})},
-                                            {"transformer_final_angle", List({0})},
-                                            {"min_tap", itapL},
-                                            {"max_tap", itapH},
-                                            {"step_size", itapC},
-                                            {"M_P_TLPF_list", List({sPimeas / 100})},
-                                            {"M_Q_TLPF_list", List({sQimeas / 100})},
-                                            {"outage", 0},
-                                            {"G_list",
-                                             List({-rstar / (rstar * rstar + xstar * xstar)})},
-                                            {"B_list",
-                                             List({xstar / (rstar * rstar + xstar * xstar)})},
-                                            {"BIJ_list", List({1 / xstar})},
-                                            {"kcount", 1},
-                                            {"reverse", non_reverse},
-                                            {"Decision", List({0})},
-                                            {"Analysis_decision", List({0})},
-                                            {"volt",
-                                             std::to_string(svolt) + "-" +
-                                                     std::to_string(tvolt)},
-                                            {"device_type", "双绕组变压器"},
-                                            {"CSeverity", List({-1})},
-                                            {"hB", 0},
-                                            {"G", -rstar / (rstar * rstar + xstar * xstar)},
-                                            {"B", xstar / (rstar * rstar + xstar * xstar)},
-                                            {"BIJ", 1 / xstar},
-                                            {"transformer_final_turns_ratio", tapRatio},
-                                            {"M_P_TLPF", sPimeas / 100},
-                                            {"M_Q_TLPF", sQimeas / 100},
-                                            {"line_Q1", normalLimit},
-                                            {"line_Q2", emerLimit},
-                                            {"line_Q3", ldshdLimit},
-                                            {"key_list", List({sid})},
-                                            {"from_off", List({0})},
-                                            {"to_off", List({0})},
-                                    });
-                            insertEdge(
-                                    "topo_connect",
-                                    {state(t).maxTopoID},
-                                    {state(s).maxTopoID},
-                                    {
-                                            {"edge_name", sname},
-                                            {"area", sname},
-                                            {"tap_bus", state(t).maxTopoID},
-                                            {"z_bus", state(s).maxTopoID},
-                                            {"flag", 1},
-                                            {"R", List({-rstar})},
-                                            {"X", List({xstar})},
-                                            {"hB_list", List({0})},
-                                            {"line_Q1_list", List({normalLimit})},
-                                            {"line_Q2_list", List({emerLimit})},
-                                            {"line_Q3_list", List({ldshdLimit})},
-                                            {"transformer_final_turns_ratio_list",
-                                             List({-tapRatio})},
-                                            {"transformer_final_angle", List({0})},
-                                            {"min_tap", itapL},
-                                            {"max_tap", itapH},
-                                            {"step_size", itapC},
-                                            {"M_P_TLPF_list", List({tPimeas / 100})},
-                                            {"M_Q_TLPF_list", List({tQimeas / 100})},
-                                            {"outage", 0},
-                                            {"G_list",
-                                             List({-rstar / (rstar * rstar + xstar * xstar)})},
-                                            {"B_list",
-                                             List({xstar / (rstar * rstar + xstar * xstar)})},
-                                            {"BIJ_list", List({1 / xstar})},
-                                            {"kcount", 1},
-                                            {"reverse", -non_reverse},
-                                            {"Decision", List({0})},
-                                            {"Analysis_decision", List({0})},
-                                            {"volt",
-                                             std::to_string(tvolt) + "-" +
-                                                     std::to_string(svolt)},
-                                            {"device_type", "双绕组变压器"},
-                                            {"CSeverity", List({-1})},
-                                            {"hB", 0},
-                                            {"G", -rstar / (rstar * rstar + xstar * xstar)},
-                                            {"B", xstar / (rstar * rstar + xstar * xstar)},
-                                            {"BIJ", 1 / xstar},
-                                            {"transformer_final_turns_ratio", -tapRatio},
-                                            {"M_P_TLPF", tPimeas / 100},
-                                            {"M_Q_TLPF", tQimeas / 100},
-                                            {"line_Q1", normalLimit},
-                                            {"line_Q2", emerLimit},
-                                            {"line_Q3", ldshdLimit},
-                                            {"key_list", List({tid})},
-                                            {"from_off", List({0})},
-                                            {"to_off", List({0})},
-                                    });
-                        } else {
-                            insertEdge(
-                                    "topo_connect",
-                                    {state(s).maxTopoID},
-                                    {state(t).maxTopoID},
-                                    {
-                                            {"edge_name", sname},
-                                            {"area", sname},
-                                            {"tap_bus", state(s).maxTopoID},
-                                            {"z_bus", state(t).maxTopoID},
-                                            {"flag", 1},
-                                            {"R", List({rstar})},
-                                            {"X", List({xstar})},
-                                            {"hB_list", List({0})},
-                                            {"line_Q1_list", List({normalLimit})},
-                                            {"line_Q2_list", List({emerLimit})},
-                                            {"line_Q3_list", List({ldshdLimit})},
-                                            {"transformer_final_turns_ratio_list",
-                                             List({tapRatio})},
-                                            {"transformer_final_angle", List({0})},
-                                            {"min_tap", itapL},
-                                            {"max_tap", itapH},
-                                            {"step_size", itapC},
-                                            {"M_P_TLPF_list", List({sPimeas / 100})},
-                                            {"M_Q_TLPF_list", List({sQimeas / 100})},
-                                            {"outage", 0},
-                                            {"G_list",
-                                             List({rstar / (rstar * rstar + xstar * xstar)})},
-                                            {"B_list",
-                                             List({xstar / (rstar * rstar + xstar * xstar)})},
-                                            {"BIJ_list", List({1 / xstar})},
-                                            {"kcount", 1},
-                                            {"reverse", non_reverse},
-                                            {"Decision", List({0})},
-                                            {"Analysis_decision", List({0})},
-                                            {"volt",
-                                             std::to_string(svolt) + "-" +
-                                                     std::to_string(tvolt)},
-                                            {"device_type", "双绕组变压器"},
-                                            {"CSeverity", List({-1})},
-                                            {"hB", 0},
-                                            {"G", rstar / (rstar * rstar + xstar * xstar)},
-                                            {"B", xstar / (rstar * rstar + xstar * xstar)},
-                                            {"BIJ", 1 / xstar},
-                                            {"transformer_final_turns_ratio", tapRatio},
-                                            {"M_P_TLPF", sPimeas / 100},
-                                            {"M_Q_TLPF", sQimeas / 100},
-                                            {"line_Q1", normalLimit},
-                                            {"line_Q2", emerLimit},
-                                            {"line_Q3", ldshdLimit},
-                                            {"key_list", List({sid})},
-                                            {"from_off", List({0})},
-                                            {"to_off", List({0})},
-                                    });
-                            insertEdge(
-                                    "topo_connect",
-                                    {state(t).maxTopoID},
-                                    {state(s).maxTopoID},
-                                    {
-                                            {"edge_name", sname},
-                                            {"area", sname},
-                                            {"tap_bus", state(t).maxTopoID},
-                                            {"z_bus", state(s).maxTopoID},
-                                            {"flag", 1},
-                                            {"R", List({rstar})},
-                                            {"X", List({xstar})},
-                                            {"hB_list", List({0})},
-                                            {"line_Q1_list", List({normalLimit})},
-                                            {"line_Q2_list", List({emerLimit})},
-                                            {"line_Q3_list", List({ldshdLimit})},
-                                            {"transformer_final_turns_ratio_list",
-                                             List({-tapRatio})},
-                                            {"transformer_final_angle", List({0})},
-                                            {"min_tap", itapL},
-                                            {"max_tap", itapH},
-                                            {"step_size", itapC},
-                                            {"M_P_TLPF_list", List({tPimeas / 100})},
-                                            {"M_Q_TLPF_list", List({tQimeas / 100})},
-                                            {"outage", 0},
-                                            {"G_list",
-                                             List({rstar / (rstar * rstar + xstar * xstar)})},
-                                            {"B_list",
-                                             List({xstar / (rstar * rstar + xstar * xstar)})},
-                                            {"BIJ_list", List({1 / xstar})},
-                                            {"kcount", 1},
-                                            {"reverse", -non_reverse},
-                                            {"Decision", List({0})},
-                                            {"Analysis_decision", List({0})},
-                                            {"volt",
-                                             std::to_string(tvolt) + "-" +
-                                                     std::to_string(svolt)},
-                                            {"device_type", "双绕组变压器"},
-                                            {"CSeverity", List({-1})},
-                                            {"hB", 0},
-                                            {"G", rstar / (rstar * rstar + xstar * xstar)},
-                                            {"B", xstar / (rstar * rstar + xstar * xstar)},
-                                            {"BIJ", 1 / xstar},
-                                            {"transformer_final_turns_ratio", -tapRatio},
-                                            {"M_P_TLPF", tPimeas / 100},
-                                            {"M_Q_TLPF", tQimeas / 100},
-                                            {"line_Q1", normalLimit},
-                                            {"line_Q2", emerLimit},
-                                            {"line_Q3", ldshdLimit},
-                                            {"key_list", List({tid})},
-                                            {"from_off", List({0})},
-                                            {"to_off", List({0})},
-                                    });
-                        }
+                        GatheredBranch branch;
+                        auto &rec = branch.rec;
+                        rec = TopoConnectRecord::impedance(BranchKind::kTwoPortTransformer,
+                                                           state(s).maxTopoID,
+                                                           state(t).maxTopoID,
+                                                           rstar,
+                                                           xstar);
+                        rec.name = sname;
+                        rec.voltFrom = svolt;
+                        rec.voltTo = tvolt;
+                        rec.key = sid;
+                        rec.turnsRatio = tapRatio;
+                        rec.minTap = itapL;
+                        rec.maxTap = itapH;
+                        rec.stepSize = itapC;
+                        rec.mP = sPimeas / 100;
+                        rec.mQ = sQimeas / 100;
+                        branch.back = TopoConnectOverlay{tid, tPimeas / 100, tQimeas / 100};
+                        branch.s = ss;
+                        res.emplace_back(std::move(branch));
                     }
                 }
             }
-
-            return std::vector<NodeID>{};
-        });
+            return res;
+        };
 
         //////////////////////// Insert for three_port transformer ID //////////////////////
 
         VertexSubset y1 =
                 cnOpenSub
-                        .map([this, graph](NodeID s) {
-                            return graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                                return getEdgeLabelSet(e.getEdgeID()).count("CN_tx_three");
-                            });
+                        .map([this](NodeID s) {
+                            return neighborIDs(s, cnTxThreeLabel);
                         })
-                        .filter([graph](NodeID t) {
-                            return graph->getProperty(t, "off").getInt64() == 0;
+                        .filter([this](NodeID t) {
+                            return getProperty(t, "off").getInt64() == 0;
                         });
-        VertexSubset y2 = y1.map([this, graph](NodeID s) {
+        profiler().lap("y1", cnOpenSub.size(), y1.size());
+        auto gatherTxThree = [this](NodeID s) {
+            std::vector<GatheredBranch> res;
             if (state(s).maxTopoID == 0) {
-                return std::vector<NodeID>{};
+                return res;
             }
 
-            auto rstar = graph->getProperty(s, "Rstar").getDouble();
-            auto xstar = graph->getProperty(s, "Xstar").getDouble();
-            auto st = graph->getProperty(s, "t").getDouble();
-            auto ss = graph->getProperty(s, "S").getDouble();
-            auto sname = graph->getProperty(s, "name").getString();
-            auto itapL = graph->getProperty(s, "itapL").getDouble();
-            auto itapH = graph->getProperty(s, "itapH").getDouble();
-            auto itapC = graph->getProperty(s, "itapC").getDouble();
-            auto sPimeas = graph->getProperty(s, "Pimeas").getDouble();
-            auto sQimeas = graph->getProperty(s, "Qimeas").getDouble();
-            auto svolt = graph->getProperty(s, "volt").getDouble();
-            auto sid = graph->getProperty(s, "id").getInt64();
-
-            double ratio = rstar / xstar;
-            UNUSED(ratio);
+            auto rstar = getProperty(s, "Rstar").getDouble();
+            auto xstar = getProperty(s, "Xstar").getDouble();
+            auto st = getProperty(s, "t").getDouble();
+            auto ss = getProperty(s, "S").getDouble();
+            auto sname = getProperty(s, "name").getString();
+            auto itapL = getProperty(s, "itapL").getDouble();
+            auto itapH = getProperty(s, "itapH").getDouble();
+            auto itapC = getProperty(s, "itapC").getDouble();
+            auto sPimeas = getProperty(s, "Pimeas").getDouble();
+            auto sQimeas = getProperty(s, "Qimeas").getDouble();
+            auto svolt = getProperty(s, "volt").getDouble();
+            auto sid = getProperty(s, "id").getInt64();
+
             double tapRatioThree = st;
             if (tapRatioThree < 1.0) {
                 tapRatioThree = 1.0;
             }
-            double normalLimit = ss / 100;
-            double emerLimit = 1.1 * normalLimit;
-            double ldshdLimit = 1.2 * normalLimit;
-            if (normalLimit < 0.1) {
-                normalLimit = 9999;
-                emerLimit = 9999;
-                ldshdLimit = 9999;
-            }
 
-            std::unordered_set<NodeID> tgts;
-            auto f = [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("neutral_three");
-            };
-            for (auto t : graph->neighborIDs(s, f)) {
-                auto iOff = graph->getProperty(t, "I_off").getInt64();
-                auto kOff = graph->getProperty(t, "K_off").getInt64();
-                auto jOff = graph->getProperty(t, "J_off").getInt64();
+            for (auto t : neighborIDs(s, neutralThreeLabel)) {
+                auto iOff = getProperty(t, "I_off").getInt64();
+                auto kOff = getProperty(t, "K_off").getInt64();
+                auto jOff = getProperty(t, "J_off").getInt64();
                 if (iOff + kOff + jOff <= 1) {
-                    tgts.emplace(t);
-                    auto tMiddlePoint = graph->getProperty(t, "middle_point").getInt64();
-                    if (rstar < 0) {
-                        insertEdge("topo_connect",
-                                   {state(s).maxTopoID},
-                                   {tMiddlePoint},
-                                   {
-                                           {"edge_name", sname},
-                                           {"area", sname},
-                                           {"tap_bus", state(s).maxTopoID},
-                                           {"z_bus", tMiddlePoint},
-                                           {"flag", 1},
-                                           {"R", List({-rstar})},
-                                           {"X", List({xstar})},
-                                           {"hB_list", List({0})},
-                                           {"line_Q1_list", List({normalLimit})},
-                                           {"line_Q2_list", List({emerLimit})},
-                                           {"line_Q3_list", List({ldshdLimit})},
-                                           {"transformer_final_turns_ratio_list",
-                                            List({tapRatioThree})},
-                                           {"transformer_final_angle", List({0})},
-                                           {"min_tap", itapL},
-                                           {"max_tap", itapH},
-                                           {"step_size", itapC},
-                                           {"M_P_TLPF_list", List({sPimeas / 100})},
-                                           {"M_Q_TLPF_list", List({sQimeas / 100})},
-                                           {"outage", 0},
-                                           {"G_list",
-                                            List({-rstar / (rstar * rstar + xstar * xstar)})},
-                                           {"B_list",
-                                            List({xstar / (rstar * rstar + xstar * xstar)})},
-                                           {"BIJ_list", List({1 / xstar})},
-                                           {"kcount", 1},
-                                           {"reverse", 1},
-                                           {"Decision", List({0})},
-                                           {"Analysis_decision", List({0})},
-                                           {"volt", std::to_string(svolt)},
-                                           {"device_type", "三绕组变压器"},
-                                           {"CSeverity", List({-1})},
-                                           {"hB", 0},
-                                           {"G", -rstar / (rstar * rstar + xstar * xstar)},
-                                           {"B", xstar / (rstar * rstar + xstar * xstar)},
-                                           {"BIJ", 1 / xstar},
-                                           {"transformer_final_turns_ratio", tapRatioThree},
-                                           {"M_P_TLPF", sPimeas / 100},
-                                           {"M_Q_TLPF", sQimeas / 100},
-                                           {"line_Q1", normalLimit},
-                                           {"line_Q2", emerLimit},
-                                           {"line_Q3", ldshdLimit},
-                                           {"key_list", List({sid})},
-                                           {"from_off", List({0})},
-                                           {"to_off", List({0})},
-                                   });
-                        insertEdge("topo_connect",
-                                   {tMiddlePoint},
-                                   {state(s).maxTopoID},
-                                   {
-                                           {"edge_name", sname},
-                                           {"area", sname},
-                                           {"tap_bus", tMiddlePoint},
-                                           {"z_bus", state(s).maxTopoID},
-                                           {"flag", 1},
-                                           {"R", List({-rstar})},
-                                           {"X", List({xstar})},
-                                           {"hB_list", List({0})},
-                                           {"line_Q1_list", List({normalLimit})},
-                                           {"line_Q2_list", List({emerLimit})},
-                                           {"line_Q3_list", List({ldshdLimit})},
-                                           {"transformer_final_turns_ratio_list",
-                                            List({-tapRatioThree})},
-                                           {"transformer_final_angle", List({0})},
-                                           {"min_tap", itapL},
-                                           {"max_tap", itapH},
-                                           {"step_size", itapC},
-                                           {"outage", 0},
-                                           {"G_list",
-                                            List({-rstar / (rstar * rstar + xstar * xstar)})},
-                                           {"B_list",
-                                            List({xstar / (rstar * rstar + xstar * xstar)})},
-                                           {"BIJ_list", List({1 / xstar})},
-                                           {"kcount", 1},
-                                           {"reverse", -1},
-                                           {"Decision", List({0})},
-                                           {"Analysis_decision", List({0})},
-                                           {"volt", std::to_string(svolt)},
-                                           {"device_type", "三绕组变压器"},
-                                           {"CSeverity", List({-1})},
-                                           {"hB", 0},
-                                           {"G", -rstar / (rstar * rstar + xstar * xstar)},
-                                           {"B", xstar / (rstar * rstar + xstar * xstar)},
-                                           {"BIJ", 1 / xstar},
-                                           {"transformer_final_turns_ratio", -tapRatioThree},
-                                           {"line_Q1", normalLimit},
-                                           {"line_Q2", emerLimit},
-                                           {"line_Q3", ldshdLimit},
-                                           {"key_list", List({-sid})},
-                                           {"from_off", List({0})},
-                                           {"to_off", List({0})},
-                                   });
-                    } else {
-                        insertEdge("topo_connect",
-                                   {state(s).maxTopoID},
-                                   {tMiddlePoint},
-                                   {
-                                           {"edge_name", sname},
-                                           {"area", sname},
-                                           {"tap_bus", state(s).maxTopoID},
-                                           {"z_bus", tMiddlePoint},
-                                           {"flag", 1},
-                                           {"R", List({rstar})},
-                                           {"X", List({xstar})},
-                                           {"hB_list", List({0})},
-                                           {"line_Q1_list", List({normalLimit})},
-                                           {"line_Q2_list", List({emerLimit})},
-                                           {"line_Q3_list", List({ldshdLimit})},
-                                           {"transformer_final_turns_ratio_list",
-                                            List({tapRatioThree})},
-                                           {"transformer_final_angle", List({0})},
-                                           {"min_tap", itapL},
-                                           {"max_tap", itapH},
-                                           {"step_size", itapC},
-                                           {"M_P_TLPF_list", List({sPimeas / 100})},
-                                           {"M_Q_TLPF_list", List({sQimeas / 100})},
-                                           {"outage", 0},
-                                           {"G_list",
-                                            List({rstar / (rstar * rstar + xstar * xstar)})},
-                                           {"B_list",
-                                            List({xstar / (rstar * rstar + xstar * xstar)})},
-                                           {"BIJ_list", List({1 / xstar})},
-                                           {"kcount", 1},
-                                           {"reverse", 1},
-                                           {"Decision", List({0})},
-                                           {"Analysis_decision", List({0})},
-                                           {"volt", std::to_string(svolt)},
-                                           {"device_type", "三绕组变压器"},
-                                           {"CSeverity", List({-1})},
-                                           {"hB", 0},
-                                           {"G", rstar / (rstar * rstar + xstar * xstar)},
-                                           {"B", xstar / (rstar * rstar + xstar * xstar)},
-                                           {"BIJ", 1 / xstar},
-                                           {"transformer_final_turns_ratio", tapRatioThree},
-                                           {"M_P_TLPF", sPimeas / 100},
-                                           {"M_Q_TLPF", sQimeas / 100},
-                                           {"line_Q1", normalLimit},
-                                           {"line_Q2", emerLimit},
-                                           {"line_Q3", ldshdLimit},
-                                           {"key_list", List({sid})},
-                                           {"from_off", List({0})},
-                                           {"to_off", List({0})},
-                                   });
-                        insertEdge("topo_connect",
-                                   {tMiddlePoint},
-                                   {state(s).maxTopoID},
-                                   {
-                                           {"edge_name", sname},
-                                           {"area", sname},
-                                           {"tap_bus", tMiddlePoint},
-                                           {"z_bus", state(s).maxTopoID},
-                                           {"flag", 1},
-                                           {"R", List({rstar})},
-                                           {"X", List({xstar})},
-                                           {"hB_list", List({0})},
-                                           {"line_Q1_list", List({normalLimit})},
-                                           {"line_Q2_list", List({emerLimit})},
-                                           {"line_Q3_list", List({ldshdLimit})},
-                                           {"transformer_final_turns_ratio_list",
-                                            List({-tapRatioThree})},
-                                           {"transformer_final_angle", List({0})},
-                                           {"min_tap", itapL},
-                                           {"max_tap", itapH},
-                                           {"step_size", itapC},
-                                           {"outage", 0},
-                                           {"G_list",
-                                            List({rstar / (rstar * rstar + xstar * xstar)})},
-                                           {"B_list",
-                                            List({xstar / (rstar * rstar + xstar * xstar)})},
-                                           {"BIJ_list", List({1 / xstar})},
-                                           {"kcount", 1},
-                                           {"reverse", -1},
-                                           {"Decision", List({0})},
-                                           {"Analysis_decision", List({0})},
-                                           {"volt", std::to_string(svolt)},
-                                           {"device_type", "三绕组变压器"},
-                                           {"CSeverity", List({-1})},
-                                           {"hB", 0},
-                                           {"G", rstar / (rstar * rstar + xstar * xstar)},
-                                           {"B", xstar / (rstar * rstar + xstar * xstar)},
-                                           {"BIJ", 1 / xstar},
-                                           {"transformer_final_turns_ratio", -tapRatioThree},
-                                           {"line_Q1", normalLimit},
-                                           {"line_Q2", emerLimit},
-                                           {"line_Q3", ldshdLimit},
-                                           {"key_list", List({-sid})},
-                                           {"from_off", List({0})},
-                                           {"to_off", List({0})},
-                                   });
-                    }
+                    auto tMiddlePoint = getProperty(t, "middle_point").getInt64();
+                    GatheredBranch branch;
+                    auto &rec = branch.rec;
+                    rec = TopoConnectRecord::impedance(BranchKind::kThreePortTransformer,
+                                                       state(s).maxTopoID,
+                                                       tMiddlePoint,
+                                                       rstar,
+                                                       xstar);
+                    rec.name = sname;
+                    rec.voltFrom = svolt;
+                    rec.key = sid;
+                    rec.turnsRatio = tapRatioThree;
+                    rec.minTap = itapL;
+                    rec.maxTap = itapH;
+                    rec.stepSize = itapC;
+                    rec.mP = sPimeas / 100;
+                    rec.mQ = sQimeas / 100;
+                    // The measurements are only on the winding side, not at the neutral point
+                    branch.back = TopoConnectOverlay{-sid, 0.0, 0.0, false};
+                    branch.s = ss;
+                    res.emplace_back(std::move(branch));
                 }
             }
+            return res;
+        };
 
-            return std::vector<NodeID>{tgts.begin(), tgts.end()};
-        });
+        auto engine = ctx_->engine();
+        std::vector<GatheredBranch> branches;
+        auto gather = [engine, &branches](const VertexSubset &subset, auto gatherOne) {
+            auto future = engine->parallelFor(subset.vids(), gatherOne);
+            for (auto &res : engine->runOnCurrentThread(std::move(future))) {
+                std::move(res.begin(), res.end(), std::back_inserter(branches));
+            }
+        };
+        gather(aclineOpenSub, gatherACLines);
+        profiler().lap("gatherACLines", aclineOpenSub.size(), branches.size());
+        gather(x1, gatherTxTwo);
+        profiler().lap("gatherTxTwo", x1.size(), branches.size());
+        gather(y1, gatherTxThree);
+        profiler().lap("gatherTxThree", y1.size(), branches.size());
+        auto numBranches = branches.size();
+        emitBranches(std::move(branches));
+        profiler().lap("emitBranches", numBranches);
+    }
+
+    /**
+     * @brief Compute the admittances, limits and reverse flags of the gathered branches in one
+     *  batch and emit them. The three-port transformers keep their reverse flag.
+     */
+    void emitBranches(std::vector<GatheredBranch> branches) {
+        BranchParams params;
+        params.resize(branches.size());
+        for (size_t i = 0; i < branches.size(); ++i) {
+            const auto &rec = branches[i].rec;
+            params.r[i] = rec.r;
+            params.x[i] = rec.x;
+            params.volt[i] = rec.voltFrom;
+            params.ih[i] = branches[i].ih;
+            params.s[i] = branches[i].s;
+            params.from[i] = rec.src;
+            params.to[i] = rec.dst;
+        }
+        computeBranchParams(&params);
+
+        std::vector<size_t> indices(branches.size());
+        std::iota(indices.begin(), indices.end(), 0u);
+        auto scatter = [this, &branches, &params](size_t i) {
+            auto &rec = branches[i].rec;
+            rec.r = std::abs(rec.r);
+            rec.g = params.g[i];
+            rec.b = params.b[i];
+            rec.bij = params.bij[i];
+            rec.lineQ1 = params.lineQ1[i];
+            rec.lineQ2 = params.lineQ2[i];
+            rec.lineQ3 = params.lineQ3[i];
+            if (rec.kind != BranchKind::kThreePortTransformer) {
+                rec.reverse = params.reverse[i];
+            }
+            emitEdgePair("topo_connect", std::move(rec), branches[i].back);
+        };
+        auto engine = ctx_->engine();
+        engine->runOnCurrentThread(engine->parallelFor(indices, scatter));
+    }
+
+    /**
+     * @brief Accumulate the reactive power of compensators onto the TopoNDs and topo_connect
+     *  edges.
+     */
+    void setFrmToCp(const VertexSubset &all) {
+        auto *graph = this->graph();
 
         //========================= set Frm_To_Cp =========================
         VertexSubset vTPND = verticesByAllLabels(all, {"TopoND"});
+        profiler().lap("vTPND", all.size(), vTPND.size());
         VertexSubset vCP1 =
-                vTPND.map([this, graph](NodeID s) {
-                         return graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                             return getEdgeLabelSet(e.getEdgeID()).count("topo_compensatorP");
-                         });
-                     }).filter([this](NodeID t) { return getNodeLabelSet(t).count("C_P"); });
-        VertexSubset vCN1 = vCP1.map([this, graph](NodeID s) {
-            auto qimeas = graph->getProperty(s, "Qimeas").getDouble();
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Compensator_P_CN");
-            });
+                vTPND.map([this](NodeID s) {
+                         return neighborIDs(s, edgeLabelMatcher(topoCompensatorPLabel));
+                     }).filter([this](NodeID t) { return hasNodeLabel(t, compensatorPLabel); });
+        profiler().lap("vCP1", vTPND.size(), vCP1.size());
+        VertexSubset vCN1 = vCP1.map([this](NodeID s) {
+            auto qimeas = getProperty(s, "Qimeas").getDouble();
+            auto tgts = neighborIDs(s, compensatorPCNLabel);
             std::unordered_set<NodeID> res;
             for (auto t : tgts) {
-                if (getNodeLabelSet(t).count("CN")) {
+                if (hasNodeLabel(t, cnLabel)) {
                     res.insert(t);
                     writeDouble(&state(t).sumQimeas, qimeas);
                 }
             }
             return std::vector<NodeID>{res.begin(), res.end()};
         });
-        const std::set<std::string> connCNLabels = {
-                "connected_Breaker_CN",
-                "connected_Disconnector_CN",
+        profiler().lap("vCN1", vCP1.size(), vCN1.size());
+        // Carry the sumQimeas of the CNs of the compensators along each path, every vertex on
+        // the way takes the value of the hop before it
+        auto initQ = [this](NodeID s) { return state(s).sumQimeas; };
+        auto carryQ = [this](NodeID, NodeID t, double q) {
+            writeDouble(&state(t).sumQimeas, q);
+            return state(t).sumQimeas;
         };
-        VertexSubset vBD = vCN1.map([this, graph, &connCNLabels](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this, &connCNLabels](const Edge &e) -> bool {
-                for (auto &l : getEdgeLabelSet(e.getEdgeID())) {
-                    if (connCNLabels.count(l)) {
-                        return true;
-                    }
-                }
-                return false;
-            });
-            for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vCN2 = vBD.map([this, graph, &connCNLabels](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this, &connCNLabels](const Edge &e) -> bool {
-                for (auto &l : getEdgeLabelSet(e.getEdgeID())) {
-                    if (connCNLabels.count(l)) {
-                        return true;
-                    }
-                }
-                return false;
-            });
-            for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vD4 = vCN2.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Disconnector_CN");
-            });
-            for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vCN8 = vD4.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Disconnector_CN");
-            });
-            for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vCN9 = vCN2.merge(vCN8);
-        VertexSubset vACLineDot1 = vCN9.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) {
-                return getEdgeLabelSet(e.getEdgeID()).count("aclinedot_cn");
-            });
-            for (auto t : tgts) {
-                if (getNodeLabelSet(t).count("ACline_dot")) {
-                    writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-                }
-            }
-            return tgts;
-        });
-        std::set<std::string> aclineLabels = {
-                "aclinedot_aclinedot",
-                "aclinedot_aclinedot_reverse",
+        // CN -[Breaker|Disconnector]{2}- CN -[Disconnector]{0|2}- CN -[aclinedot_cn]-
+        const LabelPath cnToACLineDot{
+                {switchLabel, 2, 2},
+                {disconnectorCNLabel, 0, 2, 2},
+                {aclinedotCNLabel, 1, 1},
         };
-        VertexSubset vACLineDot2 = vACLineDot1.map([this, graph, &aclineLabels](NodeID s) {
-            auto topoID = graph->getProperty(s, "topoID").getInt64();
+        VertexSubset vACLineDot1 = pathMap<double>(vCN1, cnToACLineDot, initQ, carryQ);
+        profiler().lap("vACLineDot1", vCN1.size(), vACLineDot1.size());
+        VertexSubset vACLineDot2 = vACLineDot1.map([this, graph](NodeID s) {
+            auto topoID = getProperty(s, "topoID").getInt64();
             std::unordered_set<NodeID> tgts;
             auto [b, e] = graph->outEdges(s);
             for (; b != e; ++b) {
-                for (auto &l : getEdgeLabelSet(*b)) {
-                    if (aclineLabels.count(l)) {
-                        auto t = b.getDstID();
-                        if (getNodeLabelSet(t).count("ACline_dot")) {
-                            writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-                            tgts.emplace(t);
-
-                            folly::RWSpinLock::WriteHolder holder(spinLock);
-                            state(t).setTopoID1.emplace(topoID);
-                            edgeList.push_back(b.getEdge());
-                        }
+                if (hasEdgeLabel(*b, aclinedotPairLabel)) {
+                    auto t = b.getDstID();
+                    if (hasNodeLabel(t, aclineDotLabel)) {
+                        writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
+                        tgts.emplace(t);
+                        updatePayload(t, [topoID](auto &p) { p.setTopoID1.emplace(topoID); });
+
+                        edgeList.add(*b);
                     }
                 }
             }
             return std::vector<NodeID>{tgts.begin(), tgts.end()};
         });
-
-        VertexSubset vD1 = vCN1.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Disconnector_CN");
-            });
+        profiler().lap("vACLineDot2", vACLineDot1.size(), vACLineDot2.size());
+
+        // CN -[Disconnector]{2}- CN -[Breaker]{2}- CN -[Disconnector]{2}- CN -[Bus]-
+        const LabelPath cnToBusByDisconnector{
+                {disconnectorCNLabel, 2, 2},
+                {breakerCNLabel, 2, 2},
+                {disconnectorCNLabel, 2, 2},
+                {busCNLabel, 1, 1},
+        };
+        VertexSubset vBus1 = pathMap<double>(vCN1, cnToBusByDisconnector, initQ, carryQ);
+        profiler().lap("vBus1", vCN1.size(), vBus1.size());
+        // CN -[Breaker]{2}- CN -[Disconnector]{2}- CN -[Bus]-
+        const LabelPath cnToBusByBreaker{
+                {breakerCNLabel, 2, 2},
+                {disconnectorCNLabel, 2, 2},
+                {busCNLabel, 1, 1},
+        };
+        VertexSubset vBus2 = pathMap<double>(vCN1, cnToBusByBreaker, initQ, carryQ);
+        profiler().lap("vBus2", vCN1.size(), vBus2.size());
+        VertexSubset vTPND3 = vBus1.filter([this](NodeID s) {
+                                       return getProperty(s, "volt").getDouble() > 400;
+                                   }).map([this](NodeID s) {
+            auto tgts = neighborIDs(s, edgeLabelMatcher(topoBusLabel));
+            std::unordered_set<NodeID> res;
+            res.reserve(tgts.size());
             for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
+                if (hasNodeLabel(t, topoNDLabel)) {
+                    writeDouble(&state(t).sumBusQMeas, std::abs(state(s).sumQimeas / 100));
+                    res.emplace(t);
+                }
             }
-            return tgts;
+            return std::vector<NodeID>{res.begin(), res.end()};
         });
-        VertexSubset vCN3 = vD1.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Disconnector_CN");
-            });
+        profiler().lap("vTPND3", vBus1.size(), vTPND3.size());
+        VertexSubset vTPND4 = vBus2.filter([this](NodeID s) {
+                                       return getProperty(s, "volt").getDouble() > 400;
+                                   }).map([this](NodeID s) {
+            auto tgts = neighborIDs(s, edgeLabelMatcher(topoBusLabel));
+            std::unordered_set<NodeID> res;
+            res.reserve(tgts.size());
             for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vB1 = vCN3.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Breaker_CN");
-            });
-            for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vCN4 = vB1.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Breaker_CN");
-            });
-            for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vD2 = vCN4.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Disconnector_CN");
-            });
-            for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vCN5 = vD2.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Disconnector_CN");
-            });
-            for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vB2 = vCN1.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Breaker_CN");
-            });
-            for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vCN6 = vB2.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Breaker_CN");
-            });
-            for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vD3 = vCN6.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Disconnector_CN");
-            });
-            for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vCN7 = vD3.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Disconnector_CN");
-            });
-            for (auto t : tgts) {
-                writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-            }
-            return tgts;
-        });
-        VertexSubset vBus1 = vCN5.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Bus_CN");
-            });
-            for (auto t : tgts) {
-                if (getNodeLabelSet(t).count("BUS")) {
-                    writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-                }
-            }
-            return tgts;
-        });
-        VertexSubset vBus2 = vCN7.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("connected_Bus_CN");
-            });
-            for (auto t : tgts) {
-                if (getNodeLabelSet(t).count("BUS")) {
-                    writeDouble(&state(t).sumQimeas, state(s).sumQimeas);
-                }
-            }
-            return tgts;
-        });
-        VertexSubset vTPND3 = vBus1.filter([graph](NodeID s) {
-                                       return graph->getProperty(s, "volt").getDouble() > 400;
-                                   }).map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("topo_bus");
-            });
-            std::unordered_set<NodeID> res;
-            res.reserve(tgts.size());
-            for (auto t : tgts) {
-                if (getNodeLabelSet(t).count("TopoND")) {
-                    writeDouble(&state(t).sumBusQMeas, std::abs(state(s).sumQimeas / 100));
-                    res.emplace(t);
-                }
-            }
-            return std::vector<NodeID>{res.begin(), res.end()};
-        });
-        VertexSubset vTPND4 = vBus2.filter([graph](NodeID s) {
-                                       return graph->getProperty(s, "volt").getDouble() > 400;
-                                   }).map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) -> bool {
-                return getEdgeLabelSet(e.getEdgeID()).count("topo_bus");
-            });
-            std::unordered_set<NodeID> res;
-            res.reserve(tgts.size());
-            for (auto t : tgts) {
-                if (getNodeLabelSet(t).count("TopoND")) {
-                    writeDouble(&state(t).sumBusQMeas, std::abs(state(s).sumQimeas / 100));
-                    res.emplace(t);
-                }
+                if (hasNodeLabel(t, topoNDLabel)) {
+                    writeDouble(&state(t).sumBusQMeas, std::abs(state(s).sumQimeas / 100));
+                    res.emplace(t);
+                }
             }
             return std::vector<NodeID>{res.begin(), res.end()};
         });
+        profiler().lap("vTPND4", vBus2.size(), vTPND4.size());
 
-        VertexSubset vTPND1 = vACLineDot1.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) {
-                return getEdgeLabelSet(e.getEdgeID()).count("topo_aclinedot");
-            });
+        VertexSubset vTPND1 = vACLineDot1.map([this](NodeID s) {
+            auto tgts = neighborIDs(s, edgeLabelMatcher(topoAclinedotLabel));
             std::unordered_set<NodeID> res;
             res.reserve(tgts.size());
             for (auto t : tgts) {
-                if (getNodeLabelSet(t).count("TopoND")) {
+                if (hasNodeLabel(t, topoNDLabel)) {
                     writeAdd<int64_t>(&state(t).sumLineNo, 1);
                     res.emplace(t);
                 }
             }
             return std::vector<NodeID>{res.begin(), res.end()};
         });
+        profiler().lap("vTPND1.sumLineNo", vACLineDot1.size(), vTPND1.size());
 
         vTPND1 = vACLineDot1.map([this, graph](NodeID s) {
-            std::string sname(graph->getProperty(s, "name").getString());
+            std::string sname(getProperty(s, "name").getString());
             std::unordered_set<NodeID> res;
 
             auto fn = [&, this](const auto &b) {
-                if (getEdgeLabelSet(*b).count("topo_aclinedot")) {
+                if (hasEdgeLabel(*b, topoAclinedotLabel)) {
                     auto t = b.getDstID();
-                    if (getNodeLabelSet(t).count("TopoND")) {
+                    if (hasNodeLabel(t, topoNDLabel)) {
                         res.emplace(t);
-                        folly::RWSpinLock::WriteHolder wh(spinLock);
-                        for (auto i : state(t).setTopoID1) {
-                            state(t).setTopoID1.emplace(i);
-                        }
-                        std::string name = getAclineName(sname);
-                        state(t).listTpndName.push_back(name);
-                        state(t).listTpndQMeas.push_back(std::abs(state(s).sumQimeas / 100));
-                        topoAclineDotEdge1.push_back(b.getEdge());
+                        auto topoIDs = payloadTopoIDs(s);
+                        auto qmeas = std::abs(state(s).sumQimeas / 100);
+                        updatePayload(t, [&, this](auto &p) {
+                            p.setTopoID1.insert(topoIDs.begin(), topoIDs.end());
+                            p.listTpndName.push_back(getAclineName(sname));
+                            p.listTpndQMeas.push_back(qmeas);
+                        });
+
+                        topoAclineDotEdge1.add(*b);
                     }
                 }
             };
@@ -1669,39 +1223,40 @@ public:
             }
             return std::vector<NodeID>{res.begin(), res.end()};
         });
+        profiler().lap("vTPND1.payload", vACLineDot1.size(), vTPND1.size());
 
-        VertexSubset vTPND2 = vACLineDot2.map([this, graph](NodeID s) {
-            auto tgts = graph->neighborIDs(s, [this](const Edge &e) {
-                return getEdgeLabelSet(e.getEdgeID()).count("topo_aclinedot");
-            });
+        VertexSubset vTPND2 = vACLineDot2.map([this](NodeID s) {
+            auto tgts = neighborIDs(s, edgeLabelMatcher(topoAclinedotLabel));
             std::unordered_set<NodeID> res;
             res.reserve(tgts.size());
             for (auto t : tgts) {
-                if (getNodeLabelSet(t).count("TopoND")) {
+                if (hasNodeLabel(t, topoNDLabel)) {
                     writeAdd<int64_t>(&state(t).sumLineNo, 1);
                     res.emplace(t);
                 }
             }
             return std::vector<NodeID>{res.begin(), res.end()};
         });
+        profiler().lap("vTPND2.sumLineNo", vACLineDot2.size(), vTPND2.size());
 
         vTPND2 = vACLineDot2.map([this, graph](NodeID s) {
-            std::string sname(graph->getProperty(s, "name").getString());
+            std::string sname(getProperty(s, "name").getString());
             std::unordered_set<NodeID> res;
             auto fn = [&, this](const auto &b) {
-                if (getEdgeLabelSet(*b).count("topo_aclinedot")) {
+                if (hasEdgeLabel(*b, topoAclinedotLabel)) {
                     auto tid = b.getDstID();
-                    if (getNodeLabelSet(tid).count("TopoND")) {
+                    if (hasNodeLabel(tid, topoNDLabel)) {
                         res.emplace(tid);
-                        auto &t = state(tid);
-                        folly::RWSpinLock::WriteHolder wh(spinLock);
-                        for (auto i : t.setTopoID1) {
-                            t.setTopoID1.emplace(i);
-                        }
-                        std::string name = getAclineName(sname);
-                        t.listTpndName.push_back(name);
-                        t.listTpndQMeas.push_back(t.sumBusQMeas / t.sumLineNo);
-                        topoAclineDotEdge2.push_back(b.getEdge());
+                        const auto &t = state(tid);
+                        auto topoIDs = payloadTopoIDs(s);
+                        auto qmeas = t.sumBusQMeas / t.sumLineNo;
+                        updatePayload(tid, [&, this](auto &p) {
+                            p.setTopoID1.insert(topoIDs.begin(), topoIDs.end());
+                            p.listTpndName.push_back(getAclineName(sname));
+                            p.listTpndQMeas.push_back(qmeas);
+                        });
+
+                        topoAclineDotEdge2.add(*b);
                     }
                 }
             };
@@ -1713,17 +1268,18 @@ public:
             }
             return std::vector<NodeID>{res.begin(), res.end()};
         });
+        profiler().lap("vTPND2.payload", vACLineDot2.size(), vTPND2.size());
 
         vTPND1.forEach([this, graph](NodeID s) {
             auto [b, e] = graph->outEdges(s);
             for (; b != e; ++b) {
-                if (getEdgeLabelSet(*b).count("topo_connect")) {
+                if (hasEdgeLabel(*b, topoConnectLabel)) {
                     auto t = b.getDstID();
-                    if (getNodeLabelSet(t).count("TopoND")) {
+                    if (hasNodeLabel(t, topoNDLabel)) {
                         auto edge = b.getEdge();
                         edge.setProperty("from_CP_list", emptyList);
                         edge.setProperty("to_CP_list", emptyList);
-                        updateEdge(edge);
+                        emitEdgeUpdate(edge);
                     }
                 }
             }
@@ -1732,59 +1288,69 @@ public:
         vTPND2.forEach([this, graph](NodeID s) {
             auto [b, e] = graph->outEdges(s);
             for (; b != e; ++b) {
-                if (getEdgeLabelSet(*b).count("topo_connect")) {
+                if (hasEdgeLabel(*b, topoConnectLabel)) {
                     auto t = b.getDstID();
-                    if (getNodeLabelSet(t).count("TopoND")) {
+                    if (hasNodeLabel(t, topoNDLabel)) {
                         auto edge = b.getEdge();
                         edge.setProperty("from_CP_list", emptyList);
                         edge.setProperty("to_CP_list", emptyList);
-                        updateEdge(edge);
+                        emitEdgeUpdate(edge);
                     }
                 }
             }
         });
+        // The edges are read back with the CP lists reset below
+        flushMutations();
+        profiler().lap("resetCPLists", vTPND1.size() + vTPND2.size());
 
         VertexSubset vTPND1ConnectedTPND2 = vTPND1.map([this, graph](NodeID s) {
             std::unordered_set<NodeID> res;
             for (auto [b, e] = graph->outEdges(s); b != e; ++b) {
-                if (getEdgeLabelSet(*b).count("topo_connect")) {
+                if (hasEdgeLabel(*b, topoConnectLabel)) {
                     auto t = b.getDstID();
-                    if (getNodeLabelSet(t).count("TopoND")) {
+                    if (hasNodeLabel(t, topoNDLabel)) {
                         res.emplace(t);
 
-                        folly::RWSpinLock::WriteHolder wh(spinLock);
-                        topoConnectEdge1.push_back(b.getEdge());
+                        topoConnectEdge1.add(*b);
                     }
                 }
             }
             return std::vector<NodeID>{res.begin(), res.end()};
         });
+        profiler().lap("vTPND1ConnectedTPND2", vTPND1.size(), vTPND1ConnectedTPND2.size());
         VertexSubset vTPND2ConnectedTPND1 = vTPND2.map([this, graph](NodeID s) {
             std::unordered_set<NodeID> res;
             for (auto [b, e] = graph->outEdges(s); b != e; ++b) {
-                if (getEdgeLabelSet(*b).count("topo_connect")) {
+                if (hasEdgeLabel(*b, topoConnectLabel)) {
                     auto t = b.getDstID();
-                    if (getNodeLabelSet(t).count("TopoND")) {
+                    if (hasNodeLabel(t, topoNDLabel)) {
                         res.emplace(t);
 
-                        folly::RWSpinLock::WriteHolder wh(spinLock);
-                        topoConnectEdge2.push_back(b.getEdge());
+                        topoConnectEdge2.add(*b);
                     }
                 }
             }
             return std::vector<NodeID>{res.begin(), res.end()};
         });
+        profiler().lap("vTPND2ConnectedTPND1", vTPND2.size(), vTPND2ConnectedTPND1.size());
+        for (auto *edges : {&edgeList,
+                            &topoAclineDotEdge1,
+                            &topoAclineDotEdge2,
+                            &topoConnectEdge1,
+                            &topoConnectEdge2}) {
+            edges->merge();
+        }
         VertexSubset vTopoSet = vTPND.map([this, graph](NodeID s) {
             std::unordered_set<NodeID> res;
             for (auto [b, e] = graph->outEdges(s); b != e; ++b) {
                 Edge edge = b.getEdge();
-                if (getEdgeLabelSet(*b).count("topo_connect")) {
+                if (hasEdgeLabel(*b, topoConnectLabel)) {
                     auto t = b.getDstID();
-                    if (getNodeLabelSet(t).count("TopoND")) {
+                    if (hasNodeLabel(t, topoNDLabel)) {
                         res.emplace(t);
                         edge.setProperty("from_CP", 0);
                         edge.setProperty("to_CP", 0);
-                        updateEdge(edge);
+                        emitEdgeUpdate(edge);
 
                         // clang-format off
                         /*
@@ -1805,35 +1371,525 @@ public:
             }
             return std::vector<NodeID>{res.begin(), res.end()};
         });
+        profiler().lap("vTopoSet", vTPND.size(), vTopoSet.size());
 
         VertexSubset tTest = vTPND.map([this, graph](NodeID s) {
             std::unordered_set<NodeID> res;
             for (auto [b, e] = graph->outEdges(s); b != e; ++b) {
-                if (getEdgeLabelSet(*b).count("topo_connect")) {
+                if (hasEdgeLabel(*b, topoConnectLabel)) {
                     auto t = b.getDstID();
-                    if (getNodeLabelSet(t).count("TopoND")) {
+                    if (hasNodeLabel(t, topoNDLabel)) {
                         res.emplace(t);
                     }
                 }
             }
             return std::vector<NodeID>{res.begin(), res.end()};
         });
-    }  // end of run
+        profiler().lap("tTest", vTPND.size(), tTest.size());
+        flushMutations();
+        profiler().lap("flushFrmToCp", vTopoSet.size());
+    }
 
-    std::string name() const override {
-        return "yj.network_topo";
+    /**
+     * @brief The effective status of the breaker/disconnector, prefer the point computed from
+     *  the discrete measurement over the one stored in the graph.
+     */
+    int64_t switchPoint(NodeID sw) const {
+        const auto &point = state(sw).point;
+        if (point.has_value() && point.value() != -1) {
+            return point.value();
+        }
+        return getProperty(sw, "point").getInt64();
     }
 
-private:
-    folly::RWSpinLock spinLock;
-    std::list<nebula::Edge> edgeList;
-    std::list<nebula::Edge> topoAclineDotEdge1;
-    std::list<nebula::Edge> topoAclineDotEdge2;
-    std::list<nebula::Edge> topoConnectEdge1;
-    std::list<nebula::Edge> topoConnectEdge2;
+    /**
+     * @brief Refresh the status of a single breaker/disconnector from its discrete
+     *  measurements, the same as `resolveSwitchPoints` does for all of them.
+     */
+    void refreshSwitchPoint(NodeID sw) {
+        auto &st = state(sw);
+        st.breakerPoint = 0;
+        st.disPoint = 0;
+        st.point = -1;
+
+        auto updated = [this](NodeID s) {
+            auto cond = [](const auto &v) -> bool { return v.getInt64() == 1; };
+            return hasProperty(s, "updateFlag", cond);
+        };
+        bool isBreaker = false, isDisconnector = false;
+        for (auto s : neighborIDs(sw, discreteBreakerLabel)) {
+            if (updated(s)) {
+                st.breakerPoint = discreteStatus(s);
+                isBreaker = true;
+            }
+        }
+        for (auto s : neighborIDs(sw, discreteDisLabel)) {
+            if (updated(s)) {
+                st.disPoint = discreteStatus(s);
+                isDisconnector = true;
+            }
+        }
+        if (isBreaker) {
+            resolveBreakerPoint(sw);
+        }
+        if (isDisconnector) {
+            resolveDisconnectorPoint(sw);
+        }
+    }
+
+    template <typename F>
+    void updatePayload(NodeID vid, F &&f) {
+        payloads.update(vid, std::forward<F>(f));
+    }
+
+    std::set<int64_t> payloadTopoIDs(NodeID vid) const {
+        std::set<int64_t> topoIDs;
+        payloads.read(vid, [&topoIDs](const TopoPayload &p) { topoIDs = p.setTopoID1; });
+        return topoIDs;
+    }
+
+    /**
+     * @brief Put the equipments of the given CNs back to the topoID they seeded, which the
+     *  last run has overwritten with the topoID of their bus, so that `buildTopoNodes` elects
+     *  the TopoND of a rebuilt bus from the same candidates as a full run.
+     */
+    void resetEquipmentSeeds(const std::vector<NodeID> &cns) {
+        auto equipMask = busEquipmentLabel;
+        equipMask |= unitCNLabel;
+        for (auto cn : cns) {
+            for (auto eq : neighborIDs(cn, equipMask)) {
+                auto iter = equipmentSeeds.find(eq);
+                state(eq).maxTopoID = iter == equipmentSeeds.end() ? -1 : iter->second;
+            }
+        }
+    }
+
+    /**
+     * @brief The TopoNDs of the given equipments and the TopoNDs at the other end of their
+     *  topo_connect edges. The edges are just written, so they are read from MemGraph.
+     */
+    VertexSubset rebuiltTopoNodes(const VertexSubset &equipments) {
+        VertexSubset topoNodes = equipments.map([this](NodeID s) {
+            std::unordered_set<NodeID> res;
+            for (auto t : neighborIDs(s, edgeLabelMatcher(topoEquipmentLabel))) {
+                if (hasNodeLabel(t, topoNDLabel)) {
+                    res.emplace(t);
+                }
+            }
+            return std::vector<NodeID>{res.begin(), res.end()};
+        });
+        VertexSubset ends = topoNodes.map([this](NodeID s) {
+            return neighborIDs(s, edgeLabelMatcher(topoConnectLabel));
+        });
+        return topoNodes.merge(ends);
+    }
+
+    /**
+     * @brief Extend the CNs with the CNs at the other end of their AC lines and two-port
+     *  transformers, so that a branch is rebuilt no matter which end of it has changed.
+     */
+    VertexSubset branchScope(const VertexSubset &cnSet) const {
+        auto equipMask = aclinedotCNLabel;
+        equipMask |= cnTxTwoLabel;
+        auto partnerMask = aclinedotPairLabel;
+        partnerMask |= transformerLineLabel;
+        VertexSubset partnerCNs = cnSet.map([&](NodeID s) {
+            std::unordered_set<NodeID> res;
+            for (auto eq : neighborIDs(s, equipMask)) {
+                for (auto partner : neighborIDs(eq, partnerMask)) {
+                    for (auto cn : neighborIDs(partner, equipMask)) {
+                        res.emplace(cn);
+                    }
+                }
+            }
+            return std::vector<NodeID>{res.begin(), res.end()};
+        });
+        return cnSet.merge(partnerCNs);
+    }
+
+    /**
+     * @brief Merge the CNs connected by closed breakers/disconnectors into buses.
+     *  The switches are swept once in parallel, each closed one uniting the CNs at its ends in
+     *  a concurrent disjoint set over the dense vertex indices, so there's no round per switch
+     *  hop within a bus. Every CN of a bus holding a CN of `cnSet` then gets the max topoID
+     *  seeded on the bus, which is independent of the order of the unions.
+     * @param cnSet The CNs whose buses are merged.
+     */
+    void mergeBuses(const VertexSubset &cnSet) {
+        auto engine = ctx_->engine();
+        const auto &index = vertexIndex();
+        std::vector<uint32_t> indices(index.size());
+        std::iota(indices.begin(), indices.end(), 0u);
+
+        nebula::computing::DisjointSet buses(index.size());
+        auto uniteEnds = [this, &index, &buses](uint32_t idx) {
+            auto sw = index.vid(idx);
+            auto ends = neighborIDs(sw, switchLabel);
+            // The CNs have the switch edges too, from the other end
+            if (ends.empty() || hasNodeLabel(sw, cnLabel) || switchPoint(sw) != 1) {
+                return;
+            }
+            auto first = index.indexOf(ends.front());
+            for (auto cn : ends) {
+                buses.unite(first, index.indexOf(cn));
+            }
+        };
+        engine->runOnCurrentThread(engine->parallelFor(indices, uniteEnds));
+
+        nebula::computing::AtomicBitSet merged(index.size());
+        auto markBus = [&index, &buses, &merged](NodeID cn) {
+            merged.testAndSet(buses.find(index.indexOf(cn)));
+        };
+        engine->runOnCurrentThread(engine->parallelFor(cnSet.vids(), markBus));
+        auto inMergedBus = [&buses, &merged](uint32_t idx) {
+            return merged.get(buses.find(idx));
+        };
+        auto cns = engine->runOnCurrentThread(engine->parallelFilter(indices, inMergedBus));
+
+        for (auto idx : cns) {
+            seeds[index.vid(idx)] = stateAt(idx).maxTopoID;
+        }
+
+        std::vector<int64_t> busTopoID(index.size(), -1);
+        auto accumulate = [this, &buses, &busTopoID](uint32_t idx) {
+            writeMax<int64_t>(&busTopoID[buses.find(idx)], stateAt(idx).maxTopoID);
+        };
+        engine->runOnCurrentThread(engine->parallelFor(cns, accumulate));
+        auto assign = [this, &buses, &busTopoID](uint32_t idx) {
+            stateAt(idx).maxTopoID = busTopoID[buses.find(idx)];
+        };
+        engine->runOnCurrentThread(engine->parallelFor(cns, assign));
+    }
+
+    /**
+     * @brief Merge the buses of scenarios [first, last) at once. A switch is closed in the
+     *  lanes of a mask, and `fixpoint` propagates the max seeded topoID between the CNs of
+     *  the touched buses through the switches lane by lane, expanding only the CNs/switches
+     *  changed in the previous round, which gives each CN the topoID `mergeBuses` would in
+     *  every scenario.
+     */
+    void evaluateScenarios(const std::vector<std::vector<SwitchTarget>> &scenarios,
+                           size_t first,
+                           size_t last,
+                           const NetworkTopoSnapshot &prev) {
+        using LaneMask = uint64_t;
+        auto numLanes = last - first;
+        LaneMask allLanes = numLanes == kScenarioLanes ? ~LaneMask{0}
+                                                       : (LaneMask{1} << numLanes) - 1;
+
+        // The lanes in which each switch is set by its scenario, and those which close it
+        struct LaneTargets {
+            LaneMask set{0};
+            LaneMask closed{0};
+        };
+        std::unordered_map<NodeID, LaneTargets> targets;
+        for (auto i = first; i < last; ++i) {
+            auto lane = LaneMask{1} << (i - first);
+            for (const auto &target : scenarios[i]) {
+                auto &lanes = targets[target.sw];
+                lanes.set |= lane;
+                lanes.closed = target.point == 1 ? lanes.closed | lane : lanes.closed & ~lane;
+            }
+        }
+
+        // Only the buses around the switches set by the scenarios could split or join
+        std::unordered_set<int64_t> busIDs;
+        for (const auto &[sw, lanes] : targets) {
+            for (auto cn : neighborIDs(sw, switchLabel)) {
+                if (prev.seeds.count(cn)) {
+                    busIDs.emplace(state(cn).maxTopoID);
+                }
+            }
+        }
+        std::unordered_map<NodeID, uint32_t> cnIndex;
+        std::vector<NodeID> cns;
+        for (auto busID : busIDs) {
+            auto iter = prev.buses.find(busID);
+            if (iter == prev.buses.end()) continue;
+            for (auto cn : iter->second) {
+                if (cnIndex.emplace(cn, cns.size()).second) {
+                    cns.push_back(cn);
+                }
+            }
+        }
+        if (cns.empty()) {
+            return;
+        }
+
+        // The slots of the CNs then the switches around them, and the lanes in which each
+        // switch is closed, the CNs are never closed
+        std::unordered_map<NodeID, uint32_t> slots(cnIndex.begin(), cnIndex.end());
+        std::vector<LaneMask> closedLanes(cns.size(), 0);
+        for (auto cn : cns) {
+            for (auto sw : neighborIDs(cn, switchLabel)) {
+                if (!slots.emplace(sw, closedLanes.size()).second) continue;
+                LaneMask closed = switchPoint(sw) == 1 ? allLanes : 0;
+                auto target = targets.find(sw);
+                if (target != targets.end()) {
+                    closed = (closed & ~target->second.set) | target->second.closed;
+                }
+                closedLanes.push_back(closed);
+            }
+        }
+
+        // The topoID of each CN/switch in each lane, the max seeded topoID of the CNs is
+        // propagated through the switches in the lanes in which they are closed
+        std::vector<int64_t> topoIDs(closedLanes.size() * kScenarioLanes, -1);
+        for (uint32_t idx = 0; idx < cns.size(); ++idx) {
+            std::fill_n(topoIDs.begin() + idx * kScenarioLanes,
+                        kScenarioLanes,
+                        prev.seeds.at(cns[idx]));
+        }
+        auto relax = [&slots, &closedLanes, &topoIDs, numCNs = cns.size()](NodeID u, NodeID v) {
+            auto from = slots.find(u);
+            auto to = slots.find(v);
+            if (from == slots.end() || to == slots.end()) {
+                return false;
+            }
+            // A switch edge has a CN at one end and the switch at the other
+            auto sw = std::max(from->second, to->second);
+            if (sw < numCNs) {
+                return false;
+            }
+            const auto *src = &topoIDs[from->second * kScenarioLanes];
+            auto *dst = &topoIDs[to->second * kScenarioLanes];
+            bool changed = false;
+            for (auto lanes = closedLanes[sw]; lanes != 0; lanes &= lanes - 1) {
+                auto lane = __builtin_ctzll(lanes);
+                changed |= writeMax<int64_t>(&dst[lane], src[lane]);
+            }
+            return changed;
+        };
+        fixpoint(VertexSubset(ctx_, cns), switchLabel, relax);
+
+        for (size_t lane = 0; lane < numLanes; ++lane) {
+            for (uint32_t idx = 0; idx < cns.size(); ++idx) {
+                auto topoID = state(cns[idx]).maxTopoID;
+                auto scenarioTopoID = topoIDs[idx * kScenarioLanes + lane];
+                if (scenarioTopoID != topoID) {
+                    scenarioDiffs.push_back(
+                            ScenarioDiff{first + lane, cns[idx], topoID, scenarioTopoID});
+                }
+            }
+        }
+    }
+
+    // The labels matched by the stages, resolved once per algorithm instance
+    const LabelMask aclineDotLabel = labelMask({"ACline_dot"});
+    const LabelMask cnLabel = labelMask({"CN"});
+    const LabelMask compensatorPLabel = labelMask({"C_P"});
+    const LabelMask topoNDLabel = labelMask({"TopoND"});
+    const LabelMask discreteLabel = labelMask({"discrete"});
+    const LabelMask aclinedotCNLabel = labelMask({"aclinedot_cn"});
+    const LabelMask aclinedotPairLabel =
+            labelMask({"aclinedot_aclinedot", "aclinedot_aclinedot_reverse"});
+    const LabelMask breakerCNLabel = labelMask({"connected_Breaker_CN"});
+    const LabelMask busCNLabel = labelMask({"connected_Bus_CN"});
+    // The equipments a TopoND is derived from, besides the units
+    const LabelMask busEquipmentLabel = labelMask({
+            "connected_Bus_CN",
+            "connected_Load_CN",
+            "CN_tx_two",
+            "aclinedot_cn",
+            "CN_tx_three",
+            "connected_Compensator_P_CN",
+    });
+    const LabelMask cnSubidLabel = labelMask({"cn_subid"});
+    const LabelMask cnTxThreeLabel = labelMask({"CN_tx_three"});
+    const LabelMask cnTxTwoLabel = labelMask({"CN_tx_two"});
+    const LabelMask compensatorPCNLabel = labelMask({"connected_Compensator_P_CN"});
+    const LabelMask compensatorSCNLabel = labelMask({"connected_Compensator_S_CN"});
+    const LabelMask disconnectorCNLabel = labelMask({"connected_Disconnector_CN"});
+    const LabelMask discreteBreakerLabel = labelMask({"discrete_breaker"});
+    const LabelMask discreteDisLabel = labelMask({"discrete_dis"});
+    const LabelMask neutralThreeLabel = labelMask({"neutral_three"});
+    const LabelMask switchLabel =
+            labelMask({"connected_Breaker_CN", "connected_Disconnector_CN"});
+    const LabelMask topoAclinedotLabel = labelMask({"topo_aclinedot"});
+    const LabelMask topoBusLabel = labelMask({"topo_bus"});
+    const LabelMask topoCompensatorPLabel = labelMask({"topo_compensatorP"});
+    const LabelMask topoConnectLabel = labelMask({"topo_connect"});
+    const LabelMask topoEquipmentLabel = labelMask({
+            "topo_unit",
+            "topo_load",
+            "topo_bus",
+            "topo_compensatorP",
+            "topo_Tx_Two",
+            "topo_Tx_Three",
+            "topo_aclinedot",
+    });
+    const LabelMask transformerLineLabel = labelMask({"txI_txJ_transformerline"});
+    const LabelMask unitCNLabel = labelMask({"connected_Unit_CN"});
+    // The edges written by a run
+    const LabelMask writtenEdgeLabel = labelMask({
+            "topo_unit",
+            "topo_load",
+            "topo_bus",
+            "topo_compensatorP",
+            "topo_Tx_Two",
+            "topo_Tx_Three",
+            "topo_aclinedot",
+            "topo_connect",
+            "topo_neutral",
+            "topoid_subid",
+    });
+
+    // The seeded topoID of the merged CNs
+    std::unordered_map<NodeID, int64_t> seeds;
+    // The seeded topoID of the equipments
+    std::unordered_map<NodeID, int64_t> equipmentSeeds;
+    // The vertices updated by the delta run
+    std::vector<NodeID> deltaVertices;
+    // The topoIDs vanished by the delta run, whose rows are left in the graph
+    std::vector<int64_t> staleTopoIDs;
+    // The topoIDs changed by the evaluated scenarios
+    std::vector<ScenarioDiff> scenarioDiffs;
+    nebula::computing::SparseSideTable<TopoPayload> payloads;
+
+    // The edges matched by the stages of setFrmToCp
+    ConcurrentCollector<EdgeID> edgeList;
+    ConcurrentCollector<EdgeID> topoAclineDotEdge1;
+    ConcurrentCollector<EdgeID> topoAclineDotEdge2;
+    ConcurrentCollector<EdgeID> topoConnectEdge1;
+    ConcurrentCollector<EdgeID> topoConnectEdge2;
     nebula::List emptyList;
 };
 
+/**
+ * @brief NetworkTopoSnapshots keeps the snapshot of the last run on each graph.
+ */
+class NetworkTopoSnapshots final {
+public:
+    using SnapshotPtr = std::shared_ptr<const NetworkTopoSnapshot>;
+
+    static SnapshotPtr get(uint32_t graphID) {
+        auto snapshots = registry().rlock();
+        auto iter = snapshots->find(graphID);
+        return iter == snapshots->end() ? nullptr : iter->second;
+    }
+
+    static void put(uint32_t graphID, SnapshotPtr snapshot) {
+        registry().wlock()->insert_or_assign(graphID, std::move(snapshot));
+    }
+
+private:
+    static folly::Synchronized<std::unordered_map<uint32_t, SnapshotPtr>> &registry() {
+        static folly::Synchronized<std::unordered_map<uint32_t, SnapshotPtr>> snapshots;
+        return snapshots;
+    }
+};
+
+/**
+ * @brief NetworkTopoCache keeps the result of the last runs on each graph with the fingerprint
+ *  of the graph, so that a call on an unchanged graph returns it without running again. The
+ *  entries are keyed by the graph ID and whether only the touched vertices are returned. The
+ *  least recently used entries are evicted to keep the estimated size of the cache under
+ *  kCapacity, and the size of an entry is acquired from the global memory tracker before
+ *  anything is evicted for it.
+ */
+class NetworkTopoCache final {
+public:
+    using Key = std::pair<uint32_t, bool>;
+    using TablePtr = std::shared_ptr<const ResultTable>;
+
+    struct Entry {
+        uint64_t fingerprint;
+        TablePtr table;
+        NetworkTopoSnapshots::SnapshotPtr snapshot;
+    };
+
+    static constexpr int64_t kCapacity = 256 * nebula::memory::MiB;
+
+    static NetworkTopoCache &instance() {
+        static NetworkTopoCache cache;
+        return cache;
+    }
+
+    /**
+     * @brief The entry of the key if it's cached with the same fingerprint.
+     */
+    std::optional<Entry> get(const Key &key, uint64_t fingerprint) {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto iter = entries_.find(key);
+        if (iter == entries_.end()) {
+            return std::nullopt;
+        }
+        if (iter->second.entry.fingerprint != fingerprint) {
+            evict(iter);
+            return std::nullopt;
+        }
+        lru_.splice(lru_.begin(), lru_, iter->second.pos);
+        return iter->second.entry;
+    }
+
+    void put(const Key &key, Entry entry) {
+        auto bytes = estimateSize(*entry.table);
+        if (bytes > kCapacity) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(lock_);
+        try {
+            tracker_.acquire(bytes);
+        } catch (const nebula::MemoryExceededException &) {
+            // Out of memory for the whole process, don't cache the result and keep the
+            // cached ones
+            return;
+        }
+        auto iter = entries_.find(key);
+        if (iter != entries_.end()) {
+            evict(iter);
+        }
+        while (!lru_.empty() && size_ + bytes > kCapacity) {
+            evict(entries_.find(lru_.back()));
+        }
+        size_ += bytes;
+        lru_.push_front(key);
+        entries_.emplace(key, Slot{std::move(entry), bytes, lru_.begin()});
+    }
+
+    ~NetworkTopoCache() {
+        tracker_.release(size_);
+    }
+
+private:
+    struct Slot {
+        Entry entry;
+        int64_t bytes;
+        std::list<Key>::iterator pos;
+    };
+
+    NetworkTopoCache() : tracker_(nebula::memory::GetGlobalMemoryTracker()) {}
+
+    /**
+     * @brief An estimate of the memory held by the table, the rows and their values. The
+     *  strings are assumed to be short and held inline.
+     */
+    static int64_t estimateSize(const ResultTable &table) {
+        int64_t bytes = sizeof(ResultTable);
+        for (const auto &row : table.getRecords()) {
+            bytes += sizeof(Row) + row.size() * sizeof(Value);
+        }
+        return bytes;
+    }
+
+    void evict(std::map<Key, Slot>::iterator iter) {
+        tracker_.release(iter->second.bytes);
+        size_ -= iter->second.bytes;
+        lru_.erase(iter->second.pos);
+        entries_.erase(iter);
+    }
+
+    // The global tracker rather than a child of it: a child counts the bytes before asking
+    // its parent for them and keeps counting them if the parent throws, while the global one
+    // rolls back a failed acquire
+    nebula::memory::GlobalMemoryTracker &tracker_;
+    std::mutex lock_;
+    // The keys from the most to the least recently used
+    std::list<Key> lru_;
+    std::map<Key, Slot> entries_;
+    int64_t size_{0};
+};
+
 }  // namespace yj
 
 
@@ -1844,8 +1900,224 @@ static constexpr const char *kColumnNames[] = {
         "jtopoID",
 };
 
+/**
+ * @brief The rows returned by a run of the network topology processing.
+ */
+enum class NetworkTopoResult {
+    kAllVertices,
+    // Only the vertices touched by the run
+    kTouchedVertices,
+    // The per-stage profile of the run instead of the vertices
+    kStageProfile,
+};
+
+/**
+ * @brief Run the network topology processing and return the rows selected by `mode`.
+ */
+static folly::Future<ExecutionOutcome> runNetworkTopo(ProcContextPtr pctx,
+                                                      std::vector<Value> args,
+                                                      NetworkTopoResult mode) {
+    ExecutionOutcome outcome;
+    outcome.status = Status::OK();
+
+    if (!pctx->rctx()) {
+        return outcome;
+    }
+
+    if (args.size() < 1u || !args[0].isString()) {
+        return outcome;
+    }
+
+    auto engine = pctx->computingEngine();
+
+    const auto &ref = args[0].getRef();
+    auto memGraph = pctx->refCatalog()->getGraph(ref.entryID());
+
+    auto ctx = std::make_unique<ComputingContext>(engine, memGraph.get(), pctx->rctx());
+    auto algo = std::make_unique<yj::NetworkTopoAlgorithm>(ctx.get());
+
+    // The profile is of a run, so it's never served from the cache
+    auto &cache = yj::NetworkTopoCache::instance();
+    auto cacheable = mode != NetworkTopoResult::kStageProfile;
+    yj::NetworkTopoCache::Key key{memGraph->ID(), mode == NetworkTopoResult::kTouchedVertices};
+    // The fingerprint doesn't cover the rows written by the run, so it's taken once for both
+    // the lookup and the result of the run
+    uint64_t fingerprint = cacheable ? algo->fingerprint() : 0;
+    if (cacheable) {
+        if (auto entry = cache.get(key, fingerprint)) {
+            yj::NetworkTopoSnapshots::put(memGraph->ID(), entry->snapshot);
+            outcome.result.emplace(*entry->table);
+            return outcome;
+        }
+    }
+
+    algo->profiler().enable(mode == NetworkTopoResult::kStageProfile);
+    algo->run();
+    auto snapshot = algo->snapshot();
+    yj::NetworkTopoSnapshots::put(memGraph->ID(), snapshot);
+
+    ResultTable table;
+    if (mode == NetworkTopoResult::kStageProfile) {
+        const auto &names = yj::NetworkTopoAlgorithm::kProfileColumnNames;
+        std::vector<std::string> colNames{std::begin(names), std::end(names)};
+        table.setColumnNames(std::move(colNames));
+        algo->getProfileResult(&table);
+    } else {
+        std::vector<std::string> colNames{std::begin(kColumnNames), std::end(kColumnNames)};
+        table.setColumnNames(std::move(colNames));
+        if (mode == NetworkTopoResult::kTouchedVertices) {
+            algo->getResult(&table,
+                            [](const yj::NetworkTopoState &st) { return st.touched(); });
+        } else {
+            algo->getResult(&table);
+        }
+    }
+
+    if (cacheable) {
+        cache.put(key, {fingerprint, std::make_shared<const ResultTable>(table), snapshot});
+    }
+
+    outcome.result.emplace(std::move(table));
+    return outcome;
+}
+
 static folly::Future<ExecutionOutcome> networkTopoProcedure(ProcContextPtr pctx,
                                                             std::vector<Value> args) {
+    return runNetworkTopo(std::move(pctx), std::move(args), NetworkTopoResult::kAllVertices);
+}
+
+static folly::Future<ExecutionOutcome> networkTopoSparseProcedure(ProcContextPtr pctx,
+                                                                  std::vector<Value> args) {
+    return runNetworkTopo(
+            std::move(pctx), std::move(args), NetworkTopoResult::kTouchedVertices);
+}
+
+static folly::Future<ExecutionOutcome> networkTopoProfileProcedure(ProcContextPtr pctx,
+                                                                   std::vector<Value> args) {
+    return runNetworkTopo(std::move(pctx), std::move(args), NetworkTopoResult::kStageProfile);
+}
+
+static folly::Future<ExecutionOutcome> networkTopoDeltaProcedure(ProcContextPtr pctx,
+                                                                 std::vector<Value> args) {
+    ExecutionOutcome outcome;
+    outcome.status = Status::OK();
+
+    if (!pctx->rctx()) {
+        return outcome;
+    }
+
+    if (args.size() < 2u || !args[0].isString() || !args[1].isList()) {
+        return outcome;
+    }
+
+    std::vector<NodeID> changedSwitches;
+    for (const auto &v : args[1].getList().values()) {
+        if (v.isInt64()) {
+            changedSwitches.push_back(v.getInt64());
+        }
+    }
+
+    auto engine = pctx->computingEngine();
+
+    const auto &ref = args[0].getRef();
+    auto memGraph = pctx->refCatalog()->getGraph(ref.entryID());
+
+    ResultTable table;
+    std::vector<std::string> colNames{std::begin(kColumnNames), std::end(kColumnNames)};
+    table.setColumnNames(std::move(colNames));
+
+    auto ctx = std::make_unique<ComputingContext>(engine, memGraph.get(), pctx->rctx());
+    auto algo = std::make_unique<yj::NetworkTopoAlgorithm>(ctx.get());
+    auto prev = yj::NetworkTopoSnapshots::get(memGraph->ID());
+    if (prev) {
+        algo->runDelta(changedSwitches, *prev);
+        algo->getDeltaResult(&table);
+    } else {
+        // No previous run to start from, fall back to the full rebuild
+        algo->run();
+        algo->getResult(&table);
+    }
+    yj::NetworkTopoSnapshots::put(memGraph->ID(), algo->snapshot());
+
+    outcome.result.emplace(std::move(table));
+    return outcome;
+}
+
+static constexpr const char *kScenarioColumnNames[] = {
+        "scenario",
+        "cn",
+        "topoID",
+        "scenarioTopoID",
+};
+
+static folly::Future<ExecutionOutcome> networkTopoScenariosProcedure(ProcContextPtr pctx,
+                                                                     std::vector<Value> args) {
+    ExecutionOutcome outcome;
+    outcome.status = Status::OK();
+
+    if (!pctx->rctx()) {
+        return outcome;
+    }
+
+    if (args.size() < 2u || !args[0].isString() || !args[1].isList()) {
+        return outcome;
+    }
+
+    // Each scenario is a list of [vid, point] pairs of the switches it sets
+    std::vector<std::vector<yj::SwitchTarget>> scenarios;
+    for (const auto &scenario : args[1].getList().values()) {
+        if (!scenario.isList()) {
+            return outcome;
+        }
+        auto &targets = scenarios.emplace_back();
+        for (const auto &v : scenario.getList().values()) {
+            if (!v.isList()) continue;
+            const auto &pair = v.getList().values();
+            if (pair.size() == 2u && pair[0].isInt64() && pair[1].isInt64()) {
+                targets.push_back(yj::SwitchTarget{pair[0].getInt64(), pair[1].getInt64()});
+            }
+        }
+    }
+
+    auto engine = pctx->computingEngine();
+
+    const auto &ref = args[0].getRef();
+    auto memGraph = pctx->refCatalog()->getGraph(ref.entryID());
+
+    auto prev = yj::NetworkTopoSnapshots::get(memGraph->ID());
+    if (!prev) {
+        // The scenarios are evaluated against the topology of a run, so do the full one first
+        auto ctx = std::make_unique<ComputingContext>(engine, memGraph.get(), pctx->rctx());
+        auto algo = std::make_unique<yj::NetworkTopoAlgorithm>(ctx.get());
+        algo->run();
+        prev = algo->snapshot();
+        yj::NetworkTopoSnapshots::put(memGraph->ID(), prev);
+    }
+
+    auto ctx = std::make_unique<ComputingContext>(engine, memGraph.get(), pctx->rctx());
+    auto algo = std::make_unique<yj::NetworkTopoAlgorithm>(ctx.get());
+    algo->runScenarios(scenarios, *prev);
+
+    ResultTable table;
+    std::vector<std::string> colNames{std::begin(kScenarioColumnNames),
+                                      std::end(kScenarioColumnNames)};
+    table.setColumnNames(std::move(colNames));
+
+    algo->getScenarioResult(&table);
+
+    outcome.result.emplace(std::move(table));
+    return outcome;
+}
+
+static constexpr const char *kDryRunColumnNames[] = {
+        "type",
+        "srcPK",
+        "dstPK",
+        "properties",
+};
+
+static folly::Future<ExecutionOutcome> networkTopoDryRunProcedure(ProcContextPtr pctx,
+                                                                  std::vector<Value> args) {
     ExecutionOutcome outcome;
     outcome.status = Status::OK();
 
@@ -1862,15 +2134,40 @@ static folly::Future<ExecutionOutcome> networkTopoProcedure(ProcContextPtr pctx,
     const auto &ref = args[0].getRef();
     auto memGraph = pctx->refCatalog()->getGraph(ref.entryID());
 
+    // The graph is left untouched, so neither is the snapshot for the delta runs
+    MutationLog log;
     auto ctx = std::make_unique<ComputingContext>(engine, memGraph.get(), pctx->rctx());
     auto algo = std::make_unique<yj::NetworkTopoAlgorithm>(ctx.get());
+    algo->captureMutations(&log);
     algo->run();
 
     ResultTable table;
-    std::vector<std::string> colNames{std::begin(kColumnNames), std::end(kColumnNames)};
+    std::vector<std::string> colNames{std::begin(kDryRunColumnNames),
+                                      std::end(kDryRunColumnNames)};
     table.setColumnNames(std::move(colNames));
 
-    algo->getResult(&table);
+    for (const auto &write : log.writes()) {
+        Row row;
+        row.append(write.type);
+        if (write.isNode()) {
+            row.append(NullValue::kNullValue);
+            row.append(NullValue::kNullValue);
+        } else {
+            row.append(List(List::vector_type{write.srcPK.begin(), write.srcPK.end()}));
+            row.append(List(List::vector_type{write.dstPK.begin(), write.dstPK.end()}));
+        }
+        if (write.type == "topo_connect") {
+            // Frm_To_Cp is skipped by a dry run, so the properties it sets are null
+            auto props = write.props;
+            for (const auto *name : {"from_CP", "to_CP", "from_CP_list", "to_CP_list"}) {
+                props.emplace(name, NullValue::kNullValue);
+            }
+            row.append(nebula::Record(std::move(props)));
+        } else {
+            row.append(nebula::Record(write.props));
+        }
+        table.append(std::move(row));
+    }
 
     outcome.result.emplace(std::move(table));
     return outcome;
@@ -1896,3 +2193,134 @@ Procedure declareNetworkTopoProcedure() {
     }
     return proc;
 }
+
+Procedure declareNetworkTopoSparseProcedure() {
+    Procedure proc;
+    proc.name = "network_topo_sparse";
+    proc.comment = "network topology processing returning only the vertices it has touched";
+    proc.func = &networkTopoSparseProcedure;
+    proc.params = {
+            Parameter{
+                    std::make_shared<nebula::StringValueType>(),
+                    "graphName",
+                    "graph name",
+            },
+    };
+    for (auto &name : kColumnNames) {
+        proc.fields.emplace_back(Field{
+                std::make_shared<nebula::StringValueType>(),
+                name,
+        });
+    }
+    return proc;
+}
+
+Procedure declareNetworkTopoProfileProcedure() {
+    Procedure proc;
+    proc.name = "network_topo_profile";
+    proc.comment = "network topology processing returning the time and work of each stage";
+    proc.func = &networkTopoProfileProcedure;
+    proc.params = {
+            Parameter{
+                    std::make_shared<nebula::StringValueType>(),
+                    "graphName",
+                    "graph name",
+            },
+    };
+    proc.fields = {
+            Field{std::make_shared<nebula::StringValueType>(), "stage"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "wallUs"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "cpuUs"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "inputSize"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "outputSize"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "edgesScanned"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "propertyReads"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "mutations"},
+    };
+    return proc;
+}
+
+Procedure declareNetworkTopoDryRunProcedure() {
+    Procedure proc;
+    proc.name = "network_topo_dry_run";
+    proc.comment =
+            "network topology processing returning the nodes/edges it would write, without "
+            "Frm_To_Cp: the from_CP/to_CP properties of topo_connect are null";
+    proc.func = &networkTopoDryRunProcedure;
+    proc.params = {
+            Parameter{
+                    std::make_shared<nebula::StringValueType>(),
+                    "graphName",
+                    "graph name",
+            },
+    };
+    auto listOf = [](auto elemType) {
+        return std::make_shared<nebula::ListValueType>(std::move(elemType));
+    };
+    proc.fields = {
+            Field{std::make_shared<nebula::StringValueType>(), "type"},
+            Field{listOf(std::make_shared<nebula::AnyValueType>()), "srcPK"},
+            Field{listOf(std::make_shared<nebula::AnyValueType>()), "dstPK"},
+            Field{std::make_shared<nebula::RecordValueType>(), "properties"},
+    };
+    return proc;
+}
+
+Procedure declareNetworkTopoDeltaProcedure() {
+    Procedure proc;
+    proc.name = "network_topo_delta";
+    proc.comment =
+            "incremental network topology processing driven by switch status changes, the rows "
+            "with a null vid are the vanished topoIDs whose rows are left in the graph";
+    proc.func = &networkTopoDeltaProcedure;
+    proc.params = {
+            Parameter{
+                    std::make_shared<nebula::StringValueType>(),
+                    "graphName",
+                    "graph name",
+            },
+            Parameter{
+                    std::make_shared<nebula::ListValueType>(
+                            std::make_shared<nebula::Int64ValueType>()),
+                    "changedSwitchIds",
+                    "vids of the breakers/disconnectors whose status has changed",
+            },
+    };
+    for (auto &name : kColumnNames) {
+        proc.fields.emplace_back(Field{
+                std::make_shared<nebula::StringValueType>(),
+                name,
+        });
+    }
+    return proc;
+}
+
+Procedure declareNetworkTopoScenariosProcedure() {
+    Procedure proc;
+    proc.name = "network_topo_scenarios";
+    proc.comment = "evaluate the bus merging of many switch-state scenarios in one pass";
+    proc.func = &networkTopoScenariosProcedure;
+    auto listOf = [](auto elemType) {
+        return std::make_shared<nebula::ListValueType>(std::move(elemType));
+    };
+    proc.params = {
+            Parameter{
+                    std::make_shared<nebula::StringValueType>(),
+                    "graphName",
+                    "graph name",
+            },
+            Parameter{
+                    listOf(listOf(listOf(std::make_shared<nebula::Int64ValueType>()))),
+                    "scenarios",
+                    "per scenario, the [vid, point] pairs of the breakers/disconnectors to "
+                    "set, point 1 for closed and 0 for open",
+            },
+    };
+    proc.fields = {
+            Field{std::make_shared<nebula::Int64ValueType>(), "scenario"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "cn"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "topoID"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "scenarioTopoID"},
+    };
+    return proc;
+}
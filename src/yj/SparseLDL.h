@@ -0,0 +1,204 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "yj/SparseMatrix.h"
+
+namespace yj {
+
+/**
+ * @brief Order the rows of a symmetric matrix by minimum degree to reduce the fill-in of its
+ *  factorization. The elimination graph is kept explicitly, which is cheap for the
+ *  sparse and nearly planar graphs of power networks.
+ * @return The permutation, the k-th row eliminated is order[k].
+ */
+inline std::vector<uint32_t> minimumDegreeOrder(const CSRMatrix<double>& a) {
+    auto n = a.size();
+    std::vector<std::vector<uint32_t>> adj(n);
+    std::set<std::pair<size_t, uint32_t>> queue;
+    for (uint32_t r = 0; r < n; ++r) {
+        for (auto c : a.cols(r)) {
+            if (c != r) {
+                adj[r].push_back(c);
+            }
+        }
+        queue.emplace(adj[r].size(), r);
+    }
+
+    std::vector<uint32_t> order;
+    order.reserve(n);
+    std::vector<uint32_t> merged;
+    while (!queue.empty()) {
+        auto v = queue.begin()->second;
+        queue.erase(queue.begin());
+        order.push_back(v);
+        // Eliminating v makes its neighbors a clique
+        auto nbrs = std::move(adj[v]);
+        adj[v].clear();
+        for (auto u : nbrs) {
+            queue.erase({adj[u].size(), u});
+            merged.clear();
+            std::set_union(adj[u].begin(),
+                           adj[u].end(),
+                           nbrs.begin(),
+                           nbrs.end(),
+                           std::back_inserter(merged));
+            merged.erase(std::remove_if(merged.begin(),
+                                        merged.end(),
+                                        [u, v](uint32_t w) { return w == u || w == v; }),
+                         merged.end());
+            adj[u].swap(merged);
+            queue.emplace(adj[u].size(), u);
+        }
+    }
+    return order;
+}
+
+/**
+ * @brief SparseLDL is the LDL' factorization of a sparse symmetric matrix, P A P' = L D L',
+ *  where P is a minimum degree ordering. It's computed up-looking row by row along the
+ *  elimination tree, L is stored by column without the unit diagonal.
+ */
+class SparseLDL final {
+public:
+    /**
+     * @brief Factorize the matrix, only the pattern and the values of the lower triangle in the
+     *  permuted order are read, so the matrix must be symmetric.
+     * @return false if a zero pivot is met, i.e. the matrix is singular.
+     */
+    bool factorize(const CSRMatrix<double>& a) {
+        auto n = a.size();
+        perm_ = minimumDegreeOrder(a);
+        pinv_.assign(n, 0u);
+        for (uint32_t k = 0; k < n; ++k) {
+            pinv_[perm_[k]] = k;
+        }
+
+        // Symbolic: the elimination tree and the number of nonzeros of each column of L
+        std::vector<uint32_t> parent(n, kNone), flag(n), lnz(n, 0u);
+        for (uint32_t k = 0; k < n; ++k) {
+            flag[k] = k;
+            for (auto c : a.cols(perm_[k])) {
+                for (auto i = pinv_[c]; i < k && flag[i] != k; i = parent[i]) {
+                    if (parent[i] == kNone) {
+                        parent[i] = k;
+                    }
+                    ++lnz[i];
+                    flag[i] = k;
+                }
+            }
+        }
+        lp_.assign(n + 1, 0u);
+        for (size_t k = 0; k < n; ++k) {
+            lp_[k + 1] = lp_[k] + lnz[k];
+        }
+        li_.assign(lp_.back(), 0u);
+        lx_.assign(lp_.back(), 0.0);
+        d_.assign(n, 0.0);
+
+        // Numeric: row k of L is the solution of a triangular system on the rows before it
+        std::vector<double> y(n, 0.0);
+        std::vector<uint32_t> pattern(n);
+        for (uint32_t k = 0; k < n; ++k) {
+            auto top = n;
+            flag[k] = k;
+            lnz[k] = 0;
+            auto row = perm_[k];
+            auto cols = a.cols(row);
+            auto vals = a.vals(row);
+            for (size_t p = 0; p < cols.size(); ++p) {
+                auto i = pinv_[cols[p]];
+                if (i > k) {
+                    continue;
+                }
+                y[i] += vals[p];
+                size_t len = 0;
+                for (; flag[i] != k; i = parent[i]) {
+                    pattern[len++] = i;
+                    flag[i] = k;
+                }
+                while (len > 0) {
+                    pattern[--top] = pattern[--len];
+                }
+            }
+            d_[k] = y[k];
+            y[k] = 0.0;
+            for (; top < n; ++top) {
+                auto i = pattern[top];
+                auto yi = y[i];
+                y[i] = 0.0;
+                auto end = lp_[i] + lnz[i];
+                for (auto p = lp_[i]; p < end; ++p) {
+                    y[li_[p]] -= lx_[p] * yi;
+                }
+                auto lki = yi / d_[i];
+                d_[k] -= lki * yi;
+                li_[end] = k;
+                lx_[end] = lki;
+                ++lnz[i];
+            }
+            if (d_[k] == 0.0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Solve A x = b in place.
+     */
+    void solve(std::vector<double>& x) const {
+        auto n = size();
+        std::vector<double> z(n);
+        for (size_t k = 0; k < n; ++k) {
+            z[k] = x[perm_[k]];
+        }
+        for (size_t j = 0; j < n; ++j) {
+            for (auto p = lp_[j]; p < lp_[j + 1]; ++p) {
+                z[li_[p]] -= lx_[p] * z[j];
+            }
+        }
+        for (size_t j = 0; j < n; ++j) {
+            z[j] /= d_[j];
+        }
+        for (size_t j = n; j-- > 0;) {
+            for (auto p = lp_[j]; p < lp_[j + 1]; ++p) {
+                z[j] -= lx_[p] * z[li_[p]];
+            }
+        }
+        for (size_t k = 0; k < n; ++k) {
+            x[perm_[k]] = z[k];
+        }
+    }
+
+    size_t size() const {
+        return d_.size();
+    }
+
+    /**
+     * @brief The number of nonzeros of L below the diagonal.
+     */
+    size_t nnz() const {
+        return li_.size();
+    }
+
+private:
+    static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+    std::vector<uint32_t> perm_;
+    std::vector<uint32_t> pinv_;
+    std::vector<size_t> lp_;
+    std::vector<uint32_t> li_;
+    std::vector<double> lx_;
+    std::vector<double> d_;
+};
+
+}  // namespace yj
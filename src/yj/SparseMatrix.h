@@ -0,0 +1,136 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <folly/Range.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "nebula/computing/ComputingEngine.h"
+
+namespace yj {
+
+/**
+ * @brief An entry of a sparse matrix in coordinate form.
+ */
+template <typename T>
+struct Triplet {
+    uint32_t row;
+    uint32_t col;
+    T val;
+};
+
+/**
+ * @brief CSRMatrix is a square sparse matrix in compressed sparse row form, the columns of
+ *  each row are sorted and unique.
+ */
+template <typename T>
+class CSRMatrix final {
+public:
+    CSRMatrix() = default;
+
+    /**
+     * @brief Assemble the matrix from the triplets, the triplets at the same position are
+     *  summed up. The rows are sorted and merged in parallel.
+     */
+    static CSRMatrix assemble(size_t n,
+                              const std::vector<Triplet<T>>& triplets,
+                              nebula::computing::ComputingEngine* engine) {
+        // Bucket the triplets by row
+        std::vector<size_t> offsets(n + 1, 0u);
+        for (const auto& t : triplets) {
+            ++offsets[t.row + 1];
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<Triplet<T>> bucketed(triplets.size());
+        auto cursor = offsets;
+        for (const auto& t : triplets) {
+            bucketed[cursor[t.row]++] = t;
+        }
+
+        // Sort each row by column and sum up the duplicates in place
+        std::vector<uint32_t> rows(n);
+        std::iota(rows.begin(), rows.end(), 0u);
+        auto merge = [&offsets, &bucketed](uint32_t r) {
+            auto begin = bucketed.begin() + offsets[r], end = bucketed.begin() + offsets[r + 1];
+            std::sort(begin, end, [](const auto& a, const auto& b) { return a.col < b.col; });
+            size_t size = 0;
+            for (auto it = begin; it != end; ++it) {
+                if (size > 0 && (begin + size - 1)->col == it->col) {
+                    (begin + size - 1)->val += it->val;
+                } else {
+                    *(begin + size++) = *it;
+                }
+            }
+            return size;
+        };
+        auto sizes = engine->runOnCurrentThread(engine->parallelFor(rows, merge));
+
+        CSRMatrix m;
+        m.offsets_.resize(n + 1, 0u);
+        for (size_t r = 0; r < n; ++r) {
+            m.offsets_[r + 1] = m.offsets_[r] + sizes[r];
+        }
+        m.cols_.resize(m.offsets_.back());
+        m.vals_.resize(m.offsets_.back());
+        auto fill = [&m, &offsets, &bucketed](uint32_t r) {
+            auto src = offsets[r];
+            for (auto dst = m.offsets_[r]; dst < m.offsets_[r + 1]; ++dst, ++src) {
+                m.cols_[dst] = bucketed[src].col;
+                m.vals_[dst] = bucketed[src].val;
+            }
+        };
+        engine->runOnCurrentThread(engine->parallelFor(rows, fill));
+        return m;
+    }
+
+    size_t size() const {
+        return offsets_.empty() ? 0u : offsets_.size() - 1;
+    }
+
+    size_t nnz() const {
+        return cols_.size();
+    }
+
+    folly::Range<const uint32_t*> cols(uint32_t r) const {
+        return {cols_.data() + offsets_[r], cols_.data() + offsets_[r + 1]};
+    }
+
+    folly::Range<const T*> vals(uint32_t r) const {
+        return {vals_.data() + offsets_[r], vals_.data() + offsets_[r + 1]};
+    }
+
+    /**
+     * @brief Get the entry at (r, c), zero if it's not stored.
+     */
+    T at(uint32_t r, uint32_t c) const {
+        auto cs = cols(r);
+        auto iter = std::lower_bound(cs.begin(), cs.end(), c);
+        if (iter == cs.end() || *iter != c) {
+            return T{};
+        }
+        return vals_[offsets_[r] + (iter - cs.begin())];
+    }
+
+    const std::vector<size_t>& offsets() const {
+        return offsets_;
+    }
+
+    const std::vector<uint32_t>& colIndices() const {
+        return cols_;
+    }
+
+    const std::vector<T>& values() const {
+        return vals_;
+    }
+
+private:
+    std::vector<size_t> offsets_;
+    std::vector<uint32_t> cols_;
+    std::vector<T> vals_;
+};
+
+}  // namespace yj
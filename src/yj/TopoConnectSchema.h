@@ -0,0 +1,430 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#pragma once
+
+#include <folly/hash/Hash.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "nebula/common/datatype/List.h"
+#include "nebula/common/datatype/Value.h"
+
+namespace yj {
+
+/**
+ * @brief The kind of the branch a topo_connect edge is built from, which decides the
+ *  properties the edge has and how they are encoded.
+ */
+enum class BranchKind : uint8_t {
+    kCSLine = 0,
+    kACLine,
+    kTwoPortTransformer,
+    kThreePortTransformer,
+};
+
+/**
+ * @brief The compile-time schema of the topo_connect edge.
+ */
+namespace topo_connect {
+
+enum Field : uint8_t {
+    kEdgeName = 0,
+    kArea,
+    kTapBus,
+    kZBus,
+    kFlag,
+    kR,
+    kX,
+    kHBList,
+    kLineQ1List,
+    kLineQ2List,
+    kLineQ3List,
+    kTurnsRatioList,
+    kFinalAngle,
+    kControlBus,
+    kSide,
+    kMinTap,
+    kMaxTap,
+    kStepSize,
+    kMPList,
+    kMQList,
+    kOutage,
+    kGList,
+    kBList,
+    kBIJList,
+    kKCount,
+    kReverse,
+    kDecision,
+    kAnalysisDecision,
+    kVolt,
+    kDeviceType,
+    kCSeverity,
+    kHB,
+    kG,
+    kB,
+    kBIJ,
+    kTurnsRatio,
+    kMP,
+    kMQ,
+    kLineQ1,
+    kLineQ2,
+    kLineQ3,
+    kKeyList,
+    kFromOff,
+    kToOff,
+    kNumFields,
+};
+
+// The branch kinds which have a field, one bit per BranchKind
+constexpr uint8_t kCS = 1u << static_cast<uint8_t>(BranchKind::kCSLine);
+constexpr uint8_t kAC = 1u << static_cast<uint8_t>(BranchKind::kACLine);
+constexpr uint8_t kTx2 = 1u << static_cast<uint8_t>(BranchKind::kTwoPortTransformer);
+constexpr uint8_t kTx3 = 1u << static_cast<uint8_t>(BranchKind::kThreePortTransformer);
+constexpr uint8_t kTx = kTx2 | kTx3;
+constexpr uint8_t kBranch = kAC | kTx;
+constexpr uint8_t kAll = kCS | kBranch;
+
+struct FieldSpec {
+    Field field;
+    std::string_view name;
+    uint8_t kinds;
+    // Whether it's one of the measurements, which a record may go without
+    bool measured;
+};
+
+constexpr std::array<FieldSpec, kNumFields> kFields = {{
+        {kEdgeName, "edge_name", kAll, false},
+        {kArea, "area", kAll, false},
+        {kTapBus, "tap_bus", kAll, false},
+        {kZBus, "z_bus", kAll, false},
+        {kFlag, "flag", kBranch, false},
+        {kR, "R", kAll, false},
+        {kX, "X", kAll, false},
+        {kHBList, "hB_list", kBranch, false},
+        {kLineQ1List, "line_Q1_list", kAll, false},
+        {kLineQ2List, "line_Q2_list", kAll, false},
+        {kLineQ3List, "line_Q3_list", kAll, false},
+        {kTurnsRatioList, "transformer_final_turns_ratio_list", kTx, false},
+        {kFinalAngle, "transformer_final_angle", kTx, false},
+        {kControlBus, "control_bus", kAC, false},
+        {kSide, "side", kAC, false},
+        {kMinTap, "min_tap", kBranch, false},
+        {kMaxTap, "max_tap", kBranch, false},
+        {kStepSize, "step_size", kBranch, false},
+        {kMPList, "M_P_TLPF_list", kBranch, true},
+        {kMQList, "M_Q_TLPF_list", kBranch, true},
+        {kOutage, "outage", kBranch, false},
+        {kGList, "G_list", kBranch, false},
+        {kBList, "B_list", kAll, false},
+        {kBIJList, "BIJ_list", kAll, false},
+        {kKCount, "kcount", kBranch, false},
+        {kReverse, "reverse", kAll, false},
+        {kDecision, "Decision", kAll, false},
+        {kAnalysisDecision, "Analysis_decision", kAll, false},
+        {kVolt, "volt", kAll, false},
+        {kDeviceType, "device_type", kAll, false},
+        {kCSeverity, "CSeverity", kAll, false},
+        {kHB, "hB", kBranch, false},
+        {kG, "G", kBranch, false},
+        {kB, "B", kAll, false},
+        {kBIJ, "BIJ", kAll, false},
+        {kTurnsRatio, "transformer_final_turns_ratio", kTx, false},
+        {kMP, "M_P_TLPF", kBranch, true},
+        {kMQ, "M_Q_TLPF", kBranch, true},
+        {kLineQ1, "line_Q1", kAll, false},
+        {kLineQ2, "line_Q2", kAll, false},
+        {kLineQ3, "line_Q3", kAll, false},
+        {kKeyList, "key_list", kBranch, false},
+        {kFromOff, "from_off", kAll, false},
+        {kToOff, "to_off", kAll, false},
+}};
+
+constexpr bool ordered() {
+    for (size_t i = 0; i < kFields.size(); ++i) {
+        if (kFields[i].field != i) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(ordered(), "kFields must be indexed by Field");
+
+}  // namespace topo_connect
+
+/**
+ * @brief The properties of a topo_connect edge which differ between the two directions of a
+ *  branch, besides the ones `TopoConnectRecord::reversed` derives from the forward edge.
+ */
+struct TopoConnectOverlay {
+    int64_t key{0};
+    double mP{0.0};
+    double mQ{0.0};
+    bool measured{true};
+
+    bool operator==(const TopoConnectOverlay& rhs) const {
+        return key == rhs.key && mP == rhs.mP && mQ == rhs.mQ && measured == rhs.measured;
+    }
+
+    size_t hash() const {
+        return folly::hash::hash_combine(key, mP, mQ, measured);
+    }
+};
+
+/**
+ * @brief TopoConnectRecord is the packed form of a topo_connect edge. The branch builders
+ *  fill it in and the mutation sink buffers it as is, the property map is only built by
+ *  `properties` when the edge is written. The constant properties are not stored, they are
+ *  encoded from the branch kind.
+ */
+struct TopoConnectRecord {
+    BranchKind kind{BranchKind::kACLine};
+    bool measured{true};
+    int32_t reverse{1};
+    int64_t src{0};
+    int64_t dst{0};
+    int64_t tapBus{0};
+    int64_t zBus{0};
+    int64_t key{0};
+    double kcount{1.0};
+    double r{0.0};
+    double x{0.0};
+    double g{0.0};
+    double b{0.0};
+    double bij{0.0};
+    double hB{0.0};
+    double lineQ1{0.0};
+    double lineQ2{0.0};
+    double lineQ3{0.0};
+    double turnsRatio{0.0};
+    double minTap{0.0};
+    double maxTap{0.0};
+    double stepSize{0.0};
+    double mP{0.0};
+    double mQ{0.0};
+    // The rated voltage of the two ends, only the two-port transformers have both
+    double voltFrom{0.0};
+    double voltTo{0.0};
+    nebula::String name;
+
+    /**
+     * @brief The record of a branch from `from` to `to` with the impedance `r + jx`. The
+     *  resistance is stored as its absolute value, the same as the conductance.
+     */
+    static TopoConnectRecord branch(
+            BranchKind kind, int64_t from, int64_t to, double r, double x) {
+        auto rec = impedance(kind, from, to, r, x);
+        rec.r = std::abs(r);
+        rec.g = rec.r / (r * r + x * x);
+        rec.b = x / (r * r + x * x);
+        rec.bij = 1 / x;
+        return rec;
+    }
+
+    /**
+     * @brief The record of a branch with the raw impedance `r + jx` only, the derived
+     *  parameters are left to the batched `computeBranchParams`.
+     */
+    static TopoConnectRecord impedance(
+            BranchKind kind, int64_t from, int64_t to, double r, double x) {
+        TopoConnectRecord rec;
+        rec.kind = kind;
+        rec.src = rec.tapBus = from;
+        rec.dst = rec.zBus = to;
+        rec.r = r;
+        rec.x = x;
+        return rec;
+    }
+
+    /**
+     * @brief The record of the same branch in the opposite direction, the per-end properties
+     *  are taken from the overlay.
+     */
+    TopoConnectRecord reversed(const TopoConnectOverlay& overlay) const {
+        auto rec = *this;
+        std::swap(rec.src, rec.dst);
+        // The reversed CS line keeps the tap/z bus of the forward one
+        if (kind != BranchKind::kCSLine) {
+            std::swap(rec.tapBus, rec.zBus);
+        }
+        // Only the two-port transformers have the voltages of both ends, "to-from" backwards
+        if (kind == BranchKind::kTwoPortTransformer) {
+            std::swap(rec.voltFrom, rec.voltTo);
+        }
+        rec.reverse = -reverse;
+        rec.turnsRatio = -turnsRatio;
+        rec.key = overlay.key;
+        rec.mP = overlay.mP;
+        rec.mQ = overlay.mQ;
+        rec.measured = overlay.measured;
+        return rec;
+    }
+
+    std::vector<nebula::Value> srcPK() const {
+        return {src};
+    }
+
+    std::vector<nebula::Value> dstPK() const {
+        return {dst};
+    }
+
+    bool has(topo_connect::Field field) const {
+        const auto& spec = topo_connect::kFields[field];
+        bool ofKind = spec.kinds & (1u << static_cast<uint8_t>(kind));
+        return ofKind && (measured || !spec.measured);
+    }
+
+    /**
+     * @brief Encode a field as the same value type the schema of topo_connect has always been
+     *  written with.
+     */
+    nebula::Value value(topo_connect::Field field) const {
+        using nebula::List;
+        using namespace topo_connect;  // NOLINT
+        bool cs = kind == BranchKind::kCSLine;
+        bool ac = kind == BranchKind::kACLine;
+        switch (field) {
+            case kEdgeName:
+            case kArea:
+                return cs ? nebula::Value(List({name})) : nebula::Value(name);
+            case kTapBus:
+                return cs ? nebula::Value(static_cast<int32_t>(tapBus)) : nebula::Value(tapBus);
+            case kZBus:
+                return cs ? nebula::Value(static_cast<int32_t>(zBus)) : nebula::Value(zBus);
+            case kFlag:
+                return ac ? 0 : 1;
+            case kR:
+                return cs ? List({0}) : List({r});
+            case kX:
+                return List({x});
+            case kHBList:
+                return ac ? List({hB}) : List({0});
+            case kLineQ1List:
+                return cs ? List({200}) : List({lineQ1});
+            case kLineQ2List:
+                return cs ? List({250}) : List({lineQ2});
+            case kLineQ3List:
+                return cs ? List({300}) : List({lineQ3});
+            case kTurnsRatioList:
+                return List({turnsRatio});
+            case kFinalAngle:
+            case kDecision:
+            case kAnalysisDecision:
+            case kFromOff:
+            case kToOff:
+                return List({0});
+            case kControlBus:
+            case kSide:
+            case kOutage:
+                return 0;
+            case kMinTap:
+                return ac ? nebula::Value(0) : nebula::Value(minTap);
+            case kMaxTap:
+                return ac ? nebula::Value(0) : nebula::Value(maxTap);
+            case kStepSize:
+                return ac ? nebula::Value(0) : nebula::Value(stepSize);
+            case kMPList:
+                return List({mP});
+            case kMQList:
+                return List({mQ});
+            case kGList:
+                return List({g});
+            case kBList:
+                return List({b});
+            case kBIJList:
+                return List({bij});
+            case kKCount:
+                return ac ? nebula::Value(kcount) : nebula::Value(1);
+            case kReverse:
+                return reverse;
+            case kVolt:
+                return volt();
+            case kDeviceType:
+                return deviceType();
+            case kCSeverity:
+                return List({-1});
+            case kHB:
+                return ac ? nebula::Value(hB) : nebula::Value(0);
+            case kG:
+                return g;
+            case kB:
+                return b;
+            case kBIJ:
+                return bij;
+            case kTurnsRatio:
+                return turnsRatio;
+            case kMP:
+                return mP;
+            case kMQ:
+                return mQ;
+            case kLineQ1:
+                return cs ? nebula::Value(200) : nebula::Value(lineQ1);
+            case kLineQ2:
+                return cs ? nebula::Value(250) : nebula::Value(lineQ2);
+            case kLineQ3:
+                return cs ? nebula::Value(300) : nebula::Value(lineQ3);
+            case kKeyList:
+                return List({key});
+            case kNumFields:
+                break;
+        }
+        return nebula::Value();
+    }
+
+    nebula::properties_type properties() const {
+        nebula::properties_type props;
+        props.reserve(topo_connect::kNumFields);
+        for (const auto& spec : topo_connect::kFields) {
+            if (has(spec.field)) {
+                props.emplace(nebula::String(spec.name.data(), spec.name.size()),
+                              value(spec.field));
+            }
+        }
+        return props;
+    }
+
+    std::string volt() const {
+        if (kind == BranchKind::kTwoPortTransformer) {
+            return std::to_string(voltFrom) + "-" + std::to_string(voltTo);
+        }
+        return std::to_string(voltFrom);
+    }
+
+    const char* deviceType() const {
+        switch (kind) {
+            case BranchKind::kCSLine:
+                return "CS传输线";
+            case BranchKind::kACLine:
+                return "AC传输线";
+            case BranchKind::kTwoPortTransformer:
+                return "双绕组变压器";
+            case BranchKind::kThreePortTransformer:
+                return "三绕组变压器";
+        }
+        return "";
+    }
+
+    auto tie() const {
+        return std::tie(kind, measured, reverse, src, dst, tapBus, zBus, key, kcount, r, x, g,
+                        b, bij, hB, lineQ1, lineQ2, lineQ3, turnsRatio, minTap, maxTap,
+                        stepSize, mP, mQ, voltFrom, voltTo, name);
+    }
+
+    bool operator==(const TopoConnectRecord& rhs) const {
+        return tie() == rhs.tie();
+    }
+
+    size_t hash() const {
+        return folly::hash::hash_combine(
+                src, dst, key, reverse, std::hash<nebula::String>()(name));
+    }
+};
+
+}  // namespace yj
@@ -0,0 +1,152 @@
+// Copyright (c) 2024 vesoft inc. All rights reserved.
+
+#include <complex>
+
+#include "nebula/common/datatype/List.h"
+#include "nebula/common/graph/MemGraph.h"
+#include "nebula/common/table/RefCatalog.h"
+#include "nebula/common/valuetype/ValueType.h"
+#include "nebula/plugins/ProcedurePlugin.h"
+#include "yj/BusBranchModel.h"
+#include "yj/SparseMatrix.h"
+
+using nebula::ExecutionOutcome;
+using nebula::List;
+using nebula::ResultTable;
+using nebula::Row;
+using nebula::Status;
+using nebula::Value;
+using nebula::computing::ComputingContext;
+using nebula::plugin::Field;
+using nebula::plugin::Parameter;
+using nebula::plugin::ProcContextPtr;
+using nebula::plugin::Procedure;
+
+namespace yj {
+
+/**
+ * @brief YBusAlgorithm assembles the complex bus admittance matrix of the bus-branch model.
+ */
+class YBusAlgorithm final : public BusBranchAlgorithm {
+public:
+    using Complex = std::complex<double>;
+
+    explicit YBusAlgorithm(ComputingContext *ctx) : BusBranchAlgorithm(ctx) {}
+
+    std::string name() const override {
+        return "ybus";
+    }
+
+    void run() override {
+        model_ = loadModel();
+
+        // The pi model of each branch, with the ideal transformer at the `from` bus
+        std::vector<Triplet<Complex>> triplets;
+        triplets.reserve(model_.branches.size() * 4);
+        for (const auto &branch : model_.branches) {
+            Complex y(branch.g, -branch.b);
+            Complex charging(0.0, branch.hB);
+            triplets.push_back({branch.from, branch.from,
+                                (y + charging) / (branch.tap * branch.tap)});
+            triplets.push_back({branch.to, branch.to, y + charging});
+            triplets.push_back({branch.from, branch.to, -y / branch.tap});
+            triplets.push_back({branch.to, branch.from, -y / branch.tap});
+        }
+        ybus_ = CSRMatrix<Complex>::assemble(model_.numBuses(), triplets, ctx_->engine());
+    }
+
+    /**
+     * @brief One row per bus: the bus index, its topoid, and the column indices, real and
+     *  imaginary parts of the nonzeros of its row.
+     */
+    void getResult(ResultTable *result) const {
+        for (uint32_t r = 0; r < ybus_.size(); ++r) {
+            List::vector_type cols, gs, bs;
+            for (auto c : ybus_.cols(r)) {
+                cols.emplace_back(static_cast<int64_t>(c));
+            }
+            for (const auto &v : ybus_.vals(r)) {
+                gs.emplace_back(v.real());
+                bs.emplace_back(v.imag());
+            }
+            Row row;
+            row.append(static_cast<int64_t>(r));
+            row.append(model_.topoIDs[r]);
+            row.append(List(cols));
+            row.append(List(gs));
+            row.append(List(bs));
+            result->append(std::move(row));
+        }
+    }
+
+private:
+    BusBranchModel model_;
+    CSRMatrix<Complex> ybus_;
+};
+
+}  // namespace yj
+
+static constexpr const char *kYBusColumnNames[] = {
+        "busIndex",
+        "topoID",
+        "cols",
+        "G",
+        "B",
+};
+
+static folly::Future<ExecutionOutcome> ybusProcedure(ProcContextPtr pctx,
+                                                     std::vector<Value> args) {
+    ExecutionOutcome outcome;
+    outcome.status = Status::OK();
+
+    if (!pctx->rctx()) {
+        return outcome;
+    }
+
+    if (args.size() < 1u || !args[0].isString()) {
+        return outcome;
+    }
+
+    auto engine = pctx->computingEngine();
+
+    const auto &ref = args[0].getRef();
+    auto memGraph = pctx->refCatalog()->getGraph(ref.entryID());
+
+    auto ctx = std::make_unique<ComputingContext>(engine, memGraph.get(), pctx->rctx());
+    auto algo = std::make_unique<yj::YBusAlgorithm>(ctx.get());
+    algo->run();
+
+    ResultTable table;
+    std::vector<std::string> colNames{std::begin(kYBusColumnNames), std::end(kYBusColumnNames)};
+    table.setColumnNames(std::move(colNames));
+
+    algo->getResult(&table);
+
+    outcome.result.emplace(std::move(table));
+    return outcome;
+}
+
+Procedure declareYBusProcedure() {
+    Procedure proc;
+    proc.name = "ybus";
+    proc.comment = "assemble the bus admittance matrix of the bus-branch model in CSR form";
+    proc.func = &ybusProcedure;
+    proc.params = {
+            Parameter{
+                    std::make_shared<nebula::StringValueType>(),
+                    "graphName",
+                    "graph name",
+            },
+    };
+    auto listOf = [](auto elemType) {
+        return std::make_shared<nebula::ListValueType>(std::move(elemType));
+    };
+    proc.fields = {
+            Field{std::make_shared<nebula::Int64ValueType>(), "busIndex"},
+            Field{std::make_shared<nebula::Int64ValueType>(), "topoID"},
+            Field{listOf(std::make_shared<nebula::Int64ValueType>()), "cols"},
+            Field{listOf(std::make_shared<nebula::Float64ValueType>()), "G"},
+            Field{listOf(std::make_shared<nebula::Float64ValueType>()), "B"},
+    };
+    return proc;
+}
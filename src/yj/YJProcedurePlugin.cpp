@@ -11,6 +11,14 @@ using nebula::plugin::Procedure;
 
 // TODO: declare more DBMS procedures here
 extern Procedure declareNetworkTopoProcedure();
+extern Procedure declareNetworkTopoSparseProcedure();
+extern Procedure declareNetworkTopoProfileProcedure();
+extern Procedure declareNetworkTopoDryRunProcedure();
+extern Procedure declareNetworkTopoDeltaProcedure();
+extern Procedure declareNetworkTopoScenariosProcedure();
+extern Procedure declareYBusProcedure();
+extern Procedure declareDCPowerFlowProcedure();
+extern Procedure declareContingencyProcedure();
 
 namespace yj {
 
@@ -23,6 +31,14 @@ YJProcedurePlugin::YJProcedurePlugin()
                                      kVersion,
                                      NEBULA_PLUGIN_API_VERSION}) {
     addProcedure(declareNetworkTopoProcedure());
+    addProcedure(declareNetworkTopoSparseProcedure());
+    addProcedure(declareNetworkTopoProfileProcedure());
+    addProcedure(declareNetworkTopoDryRunProcedure());
+    addProcedure(declareNetworkTopoDeltaProcedure());
+    addProcedure(declareNetworkTopoScenariosProcedure());
+    addProcedure(declareYBusProcedure());
+    addProcedure(declareDCPowerFlowProcedure());
+    addProcedure(declareContingencyProcedure());
 }
 
 }  // namespace yj